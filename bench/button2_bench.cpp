@@ -0,0 +1,158 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Native loop() benchmark for Button2 library.
+  Measures the time per loop() call for 1 to 10000 buttons in the
+  idle, held, bouncing and multi-click states, on a virtual clock.
+  Built twice, with std::function and with function pointer handlers
+  (BUTTON2_DISABLE_STD_FUNCTION), see bench/README.md.
+
+  Output is CSV on stdout:
+    scenario,buttons,dispatch,loops,ns_per_loop,events
+
+  Created by Lennart Hennigs
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Button2.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+/////////////////////////////////////////////////////////////////
+
+#ifdef BUTTON2_HAS_STD_FUNCTION
+  #define DISPATCH "std_function"
+#else
+  #define DISPATCH "fn_ptr"
+#endif
+
+// loop() calls per scenario and button count, at least MIN_ROUNDS
+// rounds over all buttons
+#define TARGET_LOOPS  2000000UL
+#define MIN_ROUNDS    1000UL
+
+/////////////////////////////////////////////////////////////////
+
+// virtual clock, one ms per round
+static unsigned long clockMs = 0;
+// level of all buttons
+static uint8_t level = HIGH;
+// handler calls, printed so the handlers can't be optimized away
+static unsigned long events = 0;
+
+unsigned long getClockMs() {
+  return clockMs;
+}
+
+uint8_t readLevel() {
+  return level;
+}
+
+void onEvent(Button2& /* btn */) {
+  events++;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// level of the active low button at a time of the scenario
+typedef uint8_t (*Scenario)(unsigned long ms);
+
+// never pressed
+uint8_t idle(unsigned long /* ms */) {
+  return HIGH;
+}
+
+// pressed for good, a long click detected early on
+uint8_t held(unsigned long /* ms */) {
+  return LOW;
+}
+
+// a new edge every ms, never stable for the debounce time
+uint8_t bouncing(unsigned long ms) {
+  return (ms & 1) ? LOW : HIGH;
+}
+
+// triple clicks: 3x 40ms down, 40ms up, then a pause, repeated
+uint8_t multiclick(unsigned long ms) {
+  unsigned long t = ms % 640;
+  if (t >= 240) return HIGH;
+  return ((t / 40) & 1) ? HIGH : LOW;
+}
+
+/////////////////////////////////////////////////////////////////
+
+struct Run {
+  const char* name;
+  Scenario level;
+};
+
+static const Run runs[] = {
+  { "idle", idle },
+  { "held", held },
+  { "bouncing", bouncing },
+  { "multiclick", multiclick }
+};
+
+static const unsigned long sizes[] = { 1, 10, 100, 1000, 10000 };
+
+/////////////////////////////////////////////////////////////////
+
+// The typical handler set of a UI button
+void setup(Button2& btn) {
+  btn.begin(BTN_VIRTUAL_PIN);
+  btn.setButtonStateFunction(readLevel);
+  btn.setDebounceTime(10);
+  btn.setPressedHandler(onEvent);
+  btn.setReleasedHandler(onEvent);
+  btn.setClickHandler(onEvent);
+  btn.setDoubleClickHandler(onEvent);
+  btn.setTripleClickHandler(onEvent);
+  btn.setLongClickDetectedHandler(onEvent);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void measure(const Run& run, unsigned long count, unsigned long target) {
+  std::unique_ptr<Button2[]> buttons(new Button2[count]);
+  for (unsigned long i = 0; i < count; i++) setup(buttons[i]);
+
+  unsigned long rounds = target / count;
+  if (rounds < MIN_ROUNDS) rounds = MIN_ROUNDS;
+  clockMs = 0;
+  events = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned long r = 0; r < rounds; r++) {
+    level = run.level(clockMs);
+    for (unsigned long i = 0; i < count; i++) buttons[i].loop();
+    clockMs++;
+  }
+  auto stop = std::chrono::steady_clock::now();
+
+  unsigned long loops = rounds * count;
+  double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+  printf("%s,%lu,%s,%lu,%.2f,%lu\n", run.name, count, DISPATCH, loops, ns / loops, events);
+  fflush(stdout);
+}
+
+/////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+  // --quick: a smoke run for ctest, the numbers are not meaningful
+  bool quick = (argc > 1 && strcmp(argv[1], "--quick") == 0);
+  unsigned long target = quick ? TARGET_LOOPS / 100 : TARGET_LOOPS;
+
+  Button2::setTimeFunction(getClockMs);
+  printf("scenario,buttons,dispatch,loops,ns_per_loop,events\n");
+  for (const Run& run : runs) {
+    for (unsigned long count : sizes) {
+      if (quick && count > 1000) continue;
+      measure(run, count, target);
+    }
+  }
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,95 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Memory footprint program for Button2 library.
+  Built once per platform configuration, handler set and number of
+  buttons (FOOTPRINT_BUTTONS, 0 = baseline). footprint.cmake compares
+  the sizes of the programs, see bench/README.md.
+
+  Prints sizeof(Button2) and the kind of handlers:
+    <sizeof>,<std_function|fn_ptr>
+
+  Created by Lennart Hennigs
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Button2.h>
+
+#include <stdio.h>
+
+/////////////////////////////////////////////////////////////////
+
+#ifndef FOOTPRINT_BUTTONS
+#define FOOTPRINT_BUTTONS 0
+#endif
+
+// handler sets
+#define FOOTPRINT_POLL  0   // no handlers, read() in the main loop
+#define FOOTPRINT_CLICK 1   // a click handler
+#define FOOTPRINT_UI    2   // pressed, released, click, double, triple, long
+
+#ifndef FOOTPRINT_HANDLERS
+#define FOOTPRINT_HANDLERS FOOTPRINT_POLL
+#endif
+
+#ifdef BUTTON2_HAS_STD_FUNCTION
+  #define DISPATCH "std_function"
+#else
+  #define DISPATCH "fn_ptr"
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+#if FOOTPRINT_BUTTONS > 0
+
+// static, so they count as RAM of the program
+Button2 buttons[FOOTPRINT_BUTTONS];
+static unsigned long events = 0;
+
+uint8_t readLevel() {
+  return HIGH;
+}
+
+void onEvent(Button2& /* btn */) {
+  events++;
+}
+
+void setup(Button2& btn) {
+  btn.begin(BTN_VIRTUAL_PIN);
+  btn.setButtonStateFunction(readLevel);
+#if FOOTPRINT_HANDLERS == FOOTPRINT_CLICK
+  btn.setClickHandler(onEvent);
+#elif FOOTPRINT_HANDLERS == FOOTPRINT_UI
+  btn.setPressedHandler(onEvent);
+  btn.setReleasedHandler(onEvent);
+  btn.setClickHandler(onEvent);
+  btn.setDoubleClickHandler(onEvent);
+  btn.setTripleClickHandler(onEvent);
+  btn.setLongClickDetectedHandler(onEvent);
+#endif
+}
+
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+int main(int argc, char** /* argv */) {
+#if FOOTPRINT_BUTTONS > 0
+  for (Button2& btn : buttons) setup(btn);
+  // only called when asked to, the code has to be linked in either way
+  for (int i = 1; i < argc; i++) {
+    for (Button2& btn : buttons) {
+      btn.loop();
+#if FOOTPRINT_HANDLERS == FOOTPRINT_POLL
+      if (btn.read() != clickType::empty) events++;
+#endif
+    }
+  }
+  if (events > 0) return 1;
+#else
+  (void)argc;  // the baseline has no buttons to loop
+#endif
+  printf("%u,%s\n", (unsigned)sizeof(Button2), DISPATCH);
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////
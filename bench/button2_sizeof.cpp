@@ -0,0 +1,17 @@
+/////////////////////////////////////////////////////////////////
+/*
+  sizeof(Button2) in another data model for the footprint check.
+  Only compiled, e.g. with -m32, not linked: footprint.cmake reads
+  the size of `footprint_button` with nm, see bench/README.md.
+
+  Created by Lennart Hennigs
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Button2.h>
+
+/////////////////////////////////////////////////////////////////
+
+Button2 footprint_button;
+
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,117 @@
+# Footprint report and check for Button2, run by the `footprint` target
+# and test of bench/CMakeLists.txt:
+#
+#   cmake -DSIZE_TOOL=size -DDIR=<programs> -DCONFIGS=avr,esp32 \
+#         -DHANDLERS=poll,ui -DBUTTONS=1,64 -DLIMITS=footprint_limits.csv \
+#         -DREPORT=footprint.csv -P footprint.cmake
+#
+# The cost of N buttons is the size of the program with them minus the
+# size of the baseline program of the configuration:
+#   flash = text + data, ram = data + bss
+# Optionally ILP32_CONFIGS / ILP32_OBJECTS (and NM_TOOL): object files
+# with a `footprint_button`, built for 32 bit targets, checked as
+# sizeof_ilp32. Fails if a value is above its limit in LIMITS.
+
+cmake_minimum_required(VERSION 3.10)
+
+foreach(var SIZE_TOOL DIR CONFIGS HANDLERS BUTTONS LIMITS REPORT)
+  if(NOT DEFINED ${var})
+    message(FATAL_ERROR "footprint.cmake: ${var} not set")
+  endif()
+endforeach()
+string(REPLACE "," ";" CONFIGS "${CONFIGS}")
+string(REPLACE "," ";" HANDLERS "${HANDLERS}")
+string(REPLACE "," ";" BUTTONS "${BUTTONS}")
+string(REPLACE "," ";" ILP32_CONFIGS "${ILP32_CONFIGS}")
+string(REPLACE "," ";" ILP32_OBJECTS "${ILP32_OBJECTS}")
+
+# text, data and bss of a program in berkeley format
+function(read_size program prefix)
+  execute_process(COMMAND ${SIZE_TOOL} ${program}
+    OUTPUT_VARIABLE out RESULT_VARIABLE result)
+  if(NOT result EQUAL 0 OR NOT out MATCHES "\n[ \t]*([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)")
+    message(FATAL_ERROR "footprint.cmake: can't read the size of ${program}")
+  endif()
+  set(${prefix}_text ${CMAKE_MATCH_1} PARENT_SCOPE)
+  set(${prefix}_data ${CMAKE_MATCH_2} PARENT_SCOPE)
+  set(${prefix}_bss ${CMAKE_MATCH_3} PARENT_SCOPE)
+endfunction()
+
+# size of `footprint_button` in an object file
+function(read_sizeof object var)
+  execute_process(COMMAND ${NM_TOOL} -S -t d ${object}
+    OUTPUT_VARIABLE out RESULT_VARIABLE result)
+  if(NOT result EQUAL 0 OR NOT out MATCHES "[0-9]+ 0*([0-9]+) [bBdD] footprint_button\n")
+    message(FATAL_ERROR "footprint.cmake: can't read the size of the button in ${object}")
+  endif()
+  set(${var} ${CMAKE_MATCH_1} PARENT_SCOPE)
+endfunction()
+
+# limits: config,metric,limit - metric is sizeof, sizeof_ilp32,
+# ram_<buttons> or flash_<handlers>_<buttons>
+file(STRINGS ${LIMITS} lines REGEX "^[a-z0-9_]+,[a-z0-9_]+,[0-9]+$")
+foreach(line ${lines})
+  string(REPLACE "," ";" fields "${line}")
+  list(GET fields 0 config)
+  list(GET fields 1 metric)
+  list(GET fields 2 limit)
+  set(limit_${config}_${metric} ${limit})
+endforeach()
+
+set(report "config,dispatch,handlers,buttons,sizeof,flash,ram\n")
+set(failures "")
+
+# checks a value against its limit, if there is one. ram_<buttons> is
+# the same for all handler sets, reported once.
+macro(check config metric value)
+  if(DEFINED limit_${config}_${metric} AND ${value} GREATER limit_${config}_${metric})
+    set(failure "  ${config} ${metric}: ${value} > ${limit_${config}_${metric}}\n")
+    string(FIND "${failures}" "${failure}" found)
+    if(found EQUAL -1)
+      string(APPEND failures "${failure}")
+    endif()
+  endif()
+endmacro()
+
+foreach(config ${CONFIGS})
+  execute_process(COMMAND ${DIR}/footprint_${config}_base
+    OUTPUT_VARIABLE out OUTPUT_STRIP_TRAILING_WHITESPACE RESULT_VARIABLE result)
+  if(NOT result EQUAL 0 OR NOT out MATCHES "^([0-9]+),([a-z_]+)$")
+    message(FATAL_ERROR "footprint.cmake: footprint_${config}_base failed")
+  endif()
+  set(sizeof ${CMAKE_MATCH_1})
+  set(dispatch ${CMAKE_MATCH_2})
+  check(${config} sizeof ${sizeof})
+
+  read_size(${DIR}/footprint_${config}_base base)
+  foreach(handlers ${HANDLERS})
+    foreach(count ${BUTTONS})
+      read_size(${DIR}/footprint_${config}_${handlers}_${count} run)
+      math(EXPR flash "(${run_text} + ${run_data}) - (${base_text} + ${base_data})")
+      math(EXPR ram "(${run_data} + ${run_bss}) - (${base_data} + ${base_bss})")
+      string(APPEND report "${config},${dispatch},${handlers},${count},${sizeof},${flash},${ram}\n")
+      check(${config} flash_${handlers}_${count} ${flash})
+      check(${config} ram_${count} ${ram})
+    endforeach()
+  endforeach()
+endforeach()
+
+# 32 bit data model, sizeof only
+if(ILP32_CONFIGS)
+  string(APPEND report "\nconfig,data_model,sizeof\n")
+  foreach(config ${ILP32_CONFIGS})
+    list(FIND ILP32_CONFIGS ${config} index)
+    list(GET ILP32_OBJECTS ${index} object)
+    read_sizeof(${object} sizeof)
+    string(APPEND report "${config},ilp32,${sizeof}\n")
+    check(${config} sizeof_ilp32 ${sizeof})
+  endforeach()
+endif()
+
+file(WRITE ${REPORT} "${report}")
+execute_process(COMMAND ${CMAKE_COMMAND} -E echo_append "${report}")
+
+if(failures)
+  message(FATAL_ERROR "Button2 footprint above the limits in ${LIMITS}:\n${failures}"
+    "Shrink it again, or raise the limits if the growth is intended.")
+endif()
@@ -0,0 +1,34 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Arduino.cpp - Minimal Arduino API for the native Button2 benchmarks.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+*/
+/////////////////////////////////////////////////////////////////
+
+#include "Arduino.h"
+
+#include <chrono>
+#include <thread>
+
+/////////////////////////////////////////////////////////////////
+
+static const auto start = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/////////////////////////////////////////////////////////////////
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/////////////////////////////////////////////////////////////////
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+/////////////////////////////////////////////////////////////////
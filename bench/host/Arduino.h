@@ -0,0 +1,27 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Arduino.h - Minimal Arduino API for the native Button2 benchmarks.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+
+  Just enough to build Button2.cpp on a Linux/macOS host: the clock,
+  delay() and no-op pin functions. The pin constants come from
+  Button2.h, ARDUINO is not defined.
+*/
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/////////////////////////////////////////////////////////////////
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return 1; }
+
+/////////////////////////////////////////////////////////////////
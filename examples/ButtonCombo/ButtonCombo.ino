@@ -0,0 +1,77 @@
+/////////////////////////////////////////////////////////////////
+
+#include "Button2.h"
+#include "Button2Combo.h"
+
+/////////////////////////////////////////////////////////////////
+
+#define BUTTON_PIN_A  37
+#define BUTTON_PIN_B  38
+#define BUTTON_PIN_C  39
+
+/////////////////////////////////////////////////////////////////
+
+Button2 button_a, button_b, button_c;
+Button2Combo combo;
+
+enum { AB_CLICKED, AC_CLICKED, AB_HELD };
+
+/////////////////////////////////////////////////////////////////
+
+void chord(uint8_t chord) {
+  switch (chord) {
+    case AB_CLICKED:
+      Serial.println("A+B clicked");
+      break;
+    case AC_CLICKED:
+      Serial.println("A+C clicked");
+      break;
+    case AB_HELD:
+      Serial.println("A+B held for 1s");
+      break;
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+void click(Button2& btn) {
+  Serial.print("click on ");
+  Serial.println(btn.getPin());
+}
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  Serial.begin(115200);
+  delay(50);
+  Serial.println("\n\nButton Combo Demo");
+
+  button_a.begin(BUTTON_PIN_A);
+  button_a.setClickHandler(click);
+  button_b.begin(BUTTON_PIN_B);
+  button_b.setClickHandler(click);
+  button_c.begin(BUTTON_PIN_C);
+  button_c.setClickHandler(click);
+
+  combo.add(button_a);
+  combo.add(button_b);
+  combo.add(button_c);
+
+  uint16_t a = combo.maskOf(button_a);
+  uint16_t b = combo.maskOf(button_b);
+  uint16_t c = combo.maskOf(button_c);
+  combo.addChord(a | b, chord);
+  combo.addChord(a | c, chord);
+  combo.addChord(a | b, chord, 1000);
+  // no single clicks for buttons that formed a chord
+  combo.setSuppressClicks(true);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  // runs the buttons as well
+  combo.loop();
+}
+
+/////////////////////////////////////////////////////////////////
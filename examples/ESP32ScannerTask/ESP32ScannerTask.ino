@@ -0,0 +1,66 @@
+/////////////////////////////////////////////////////////////////
+
+#if !defined(ESP32)
+  #error This sketch needs an ESP32
+#else
+
+/////////////////////////////////////////////////////////////////
+
+#include "Button2.h"
+#include "Button2Scanner.h"
+
+/////////////////////////////////////////////////////////////////
+
+#define BUTTON_PIN_1  37
+#define BUTTON_PIN_2  39
+
+/////////////////////////////////////////////////////////////////
+
+Button2 button_1, button_2;
+Button2Scanner scanner;
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  Serial.begin(115200);
+  delay(50);
+  Serial.println("\n\nButton2 Scanner Task Demo");
+
+  button_1.begin(BUTTON_PIN_1);
+  button_2.begin(BUTTON_PIN_2);
+
+  // buttons must be added before the task is started
+  scanner.add(button_1);
+  scanner.add(button_2);
+  // scan every 5ms from a FreeRTOS task with priority 10
+  scanner.begin(5, 10);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  Button2Event ev;
+  // blocks for up to 1s, the scanner keeps the timing exact meanwhile
+  if (!scanner.nextEvent(ev, 1000)) return;
+
+  switch (ev.type) {
+    case click_event:
+      Serial.print("click on button ");
+      Serial.println(ev.button->getID());
+      break;
+    case double_click_event:
+      Serial.print("double click on button ");
+      Serial.println(ev.button->getID());
+      break;
+    case long_click_event:
+      Serial.print("long click on button ");
+      Serial.println(ev.button->getID());
+      break;
+    default:
+      break;
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+#endif
+/////////////////////////////////////////////////////////////////
@@ -1,4 +1,10 @@
 /////////////////////////////////////////////////////////////////
+/*
+  NOTE: loop() runs all handlers inside the timer ISR here, where
+  Serial, delay() and most other calls are not allowed. Prefer the
+  background scanner task shown in ESP32ScannerTask.ino.
+*/
+/////////////////////////////////////////////////////////////////
 
 #if !defined(ESP32)
   #error This sketch needs an ESP32
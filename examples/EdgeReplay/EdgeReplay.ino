@@ -0,0 +1,64 @@
+/////////////////////////////////////////////////////////////////
+
+#include "Button2.h"
+#include "Button2Edges.h"
+
+/////////////////////////////////////////////////////////////////
+
+#define BUTTON_PIN  2
+
+// ESP32 / ESP8266 interrupt handlers have to be placed in IRAM
+#ifndef ARDUINO_ISR_ATTR
+#define ARDUINO_ISR_ATTR
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+Button2 button;
+Button2EdgeQueue edges;
+
+/////////////////////////////////////////////////////////////////
+
+void ARDUINO_ISR_ATTR onEdge() {
+  // millis() is the button's clock and safe to call from an ISR
+  edges.push(digitalRead(BUTTON_PIN), millis());
+}
+
+/////////////////////////////////////////////////////////////////
+
+void click(Button2& btn) {
+  Serial.println("click");
+}
+
+void doubleClick(Button2& btn) {
+  Serial.println("double click");
+}
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  Serial.begin(115200);
+  delay(50);
+  Serial.println("\n\nEdge Replay Demo");
+
+  button.begin(BUTTON_PIN);
+  button.setClickHandler(click);
+  button.setDoubleClickHandler(doubleClick);
+
+  edges.begin(button);
+  attachInterrupt(digitalPinToInterrupt(BUTTON_PIN), onEdge, CHANGE);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  // runs the button as well
+  edges.loop();
+
+  // simulate a slow task, e.g. a flash write: clicks made
+  // during the delay are still told apart correctly
+  delay(1000);
+  if (edges.getDroppedEdges() > 0) Serial.println("edges dropped");
+}
+
+/////////////////////////////////////////////////////////////////
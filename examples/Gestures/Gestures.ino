@@ -0,0 +1,49 @@
+/////////////////////////////////////////////////////////////////
+
+#include "Button2.h"
+#include "Button2Gesture.h"
+
+/////////////////////////////////////////////////////////////////
+
+#define BUTTON_PIN  39
+
+/////////////////////////////////////////////////////////////////
+
+// '.' = short press, '-' = long press, '_' = hold (last symbol only)
+constexpr const char* patterns[] = { "._", "-.-", "...---..." };
+const char* const names[] = { "click + hold", "long short long", "SOS" };
+
+// built at compile time on C++14 and newer
+BUTTON2_GESTURE_CONSTEXPR Button2GestureTable<16> gestures(patterns);
+
+Button2 button;
+Button2GestureRecognizer recognizer;
+
+/////////////////////////////////////////////////////////////////
+
+void gestureHandler(Button2& btn, uint8_t gesture) {
+  Serial.print("gesture: ");
+  Serial.println(names[gesture]);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  Serial.begin(115200);
+  delay(50);
+  Serial.println("\n\nGesture Demo");
+
+  button.begin(BUTTON_PIN);
+  if (!recognizer.begin(button, gestures, gestureHandler)) {
+    Serial.println("invalid gesture table");
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  // runs the button as well
+  recognizer.loop();
+}
+
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+"""Turns the trace dumps of Button2TraceRecorder into CSV.
+
+Reads a serial log (file or stdin), picks the lines that start with
+B2T1 and writes one row per raw input change: time,id,level.
+The times are in the button's clock units (ms, us with
+BUTTON2_USE_MICROS, ticks * BUTTON2_TICK_MS in tick mode).
+
+  python3 trace2csv.py serial.log > trace.csv
+"""
+
+import sys
+
+
+def varints(data):
+    value = shift = 0
+    for b in data:
+        value |= (b & 0x7F) << shift
+        if b & 0x80:
+            shift += 7
+            continue
+        yield value
+        value = shift = 0
+
+
+def decode(line):
+    _, base, dropped, payload = line.strip().split(",", 3)
+    time = int(base)
+    values = list(varints(bytes.fromhex(payload)))
+    for tag, delta in zip(values[0::2], values[1::2]):
+        time += delta
+        yield time, tag >> 1, tag & 1
+    if int(dropped):
+        print(f"# {dropped} older records were dropped", file=sys.stderr)
+
+
+def main():
+    source = open(sys.argv[1]) if len(sys.argv) > 1 else sys.stdin
+    print("time,id,level")
+    for line in source:
+        if line.startswith("B2T1,"):
+            for row in decode(line):
+                print("%d,%d,%d" % row)
+
+
+if __name__ == "__main__":
+    main()
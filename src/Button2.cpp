@@ -13,6 +13,34 @@
 
 uint8_t Button2::_nextID = 0;
 
+/////////////////////////////////////////////////////////////////
+// sleep hook of the wait functions, delay() if not set
+
+Button2::SleepCallbackFunction Button2::_sleep_cb = BUTTON2_NULL;
+
+/////////////////////////////////////////////////////////////////
+// clock of the click logic, millis() (or micros()) if not set
+
+Button2::TimeCallbackFunction Button2::_time_cb = BUTTON2_NULL;
+
+/////////////////////////////////////////////////////////////////
+// event rate limit shared by all buttons, off if not set
+
+ButtonRateLimit Button2::_global_limit;
+
+/////////////////////////////////////////////////////////////////
+// called after the handlers of each event and on raw input changes,
+// for instrumentation
+
+Button2::DispatchCallbackFunction Button2::_dispatch_hook = BUTTON2_NULL;
+Button2::TraceCallbackFunction Button2::_trace_hook = BUTTON2_NULL;
+
+/////////////////////////////////////////////////////////////////
+
+Button2Listener::~Button2Listener() {
+  while (links != nullptr) links->button->removeListener(*this);
+}
+
 /////////////////////////////////////////////////////////////////
 //  default constructor
 
@@ -29,14 +57,19 @@ Button2::Button2(uint8_t attachTo, uint8_t buttonMode /* = INPUT_PULLUP */, bool
   _setID();
 }
 
+/////////////////////////////////////////////////////////////////
+// leaves the listeners, they may outlive the button
+
+Button2::~Button2() {
+  while (listeners != nullptr) removeListener(*listeners->listener);
+}
+
 /////////////////////////////////////////////////////////////////
 
 void Button2::begin(uint8_t attachTo, uint8_t buttonMode /* = INPUT_PULLUP */, bool activeLow /* = true */, InitCallbackFunction initCallback /* = BUTTON2_NULL */) {
   pin = attachTo;
-  longclick_counter = 0;
   longclick_retriggerable = false;
   longclick_interval_ms = 0;
-  _pressedState = activeLow ? LOW : HIGH;
 
   // Call initialization callback if provided (useful for I2C/SPI expanders, touch sensors, etc.)
   if (initCallback != BUTTON2_NULL) {
@@ -47,50 +80,204 @@ void Button2::begin(uint8_t attachTo, uint8_t buttonMode /* = INPUT_PULLUP */, b
     pinMode(attachTo, buttonMode);
   }
   //  state = activeLow ? HIGH : LOW;
-  state = _getState();
-  prev_state = state;
+  uint8_t level = _getState();
+  _beginUpdate();
+  BUTTON2_STORE(_pressedState, (uint8_t)(activeLow ? LOW : HIGH));
+  BUTTON2_STORE(longclick_counter, (uint16_t)0);
+  BUTTON2_STORE(state, level);
+  _endUpdate();
+  prev_state = level;
+  _resetDebounce();
 }
 
 /////////////////////////////////////////////////////////////////
 
 void Button2::setDebounceTime(unsigned int ms) {
-  debounce_time_ms = ms;
+  debounce_time_ms = ms * BUTTON2_TIME_PER_MS;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Separate windows for the press and the release edge.
+// release_ms = 0: the stable mode reacts to releases right away,
+// lockout and integrator use the press window for both edges.
+void Button2::setDebounceTime(unsigned int press_ms, unsigned int release_ms) {
+  debounce_time_ms = press_ms * BUTTON2_TIME_PER_MS;
+  release_debounce_ms = release_ms * BUTTON2_TIME_PER_MS;
+}
+
+/////////////////////////////////////////////////////////////////
+
+#ifdef BUTTON2_USE_MICROS
+// Windows below 1ms, e.g. for clean signals scanned at 10 kHz
+void Button2::setDebounceTimeUs(unsigned long press_us, unsigned long release_us /* = 0 */) {
+  debounce_time_ms = press_us;
+  release_debounce_ms = release_us;
+}
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+// debounce_stable (default): the press is reported once the input was
+// pressed for the debounce time, shorter presses are ignored.
+// debounce_lockout: the first edge is reported right away, further
+// edges are ignored for the debounce time. No press latency, but a
+// single glitch counts as a press.
+// debounce_integrator: every sample adds (pressed) or subtracts
+// (released) the time since the previous one, the state changes once
+// the level reaches the debounce time or 0. Tolerates noisy inputs.
+void Button2::setDebounceMode(debounceMode mode) {
+  debounce_mode = mode;
+  _resetDebounce();
 }
 
 /////////////////////////////////////////////////////////////////
 
 void Button2::setLongClickTime(unsigned int ms) {
-  longclick_time_ms = ms;
+  longclick_time_ms = ms * BUTTON2_TIME_PER_MS;
 }
 
 /////////////////////////////////////////////////////////////////
 
 void Button2::setDoubleClickTime(unsigned int ms) {
-  doubleclick_time_ms = ms;
+  doubleclick_time_ms = ms * BUTTON2_TIME_PER_MS;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Learns how fast the user double clicks and shrinks the double click
+// time to the smallest window that still captures `percent` of the
+// gaps between the presses (assuming they are normally distributed),
+// so single clicks are reported sooner. The window stays between
+// BTN_DOUBLECLICK_MIN_MS and the double click time set before the call,
+// gaps up to that time are learned even if the window is shorter.
+// `learned` must outlive the button, NULL turns it off again (the
+// window keeps its last value). A restored cadence applies right away.
+// Needs an extension, returns false without one (see setExtension()).
+bool Button2::setAdaptiveDoubleClick(ButtonClickCadence* learned, uint8_t percent /* = 95 */) {
+  if (extension == nullptr) return false;
+  extension->cadence = learned;
+  if (learned == nullptr) return true;
+  learned->limit_ms = doubleclick_time_ms / BUTTON2_TIME_PER_MS;
+  learned->percent = percent;
+  learned->after_click = false;
+  _adaptDoubleClickTime();
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Reports a click as soon as no longer sequence is possible instead of
+// waiting for the double click time: e.g. 1 = single clicks only.
+// BTN_MAX_CLICKS_AUTO derives the limit from the click handlers that are
+// set, 0 (default) always waits.
+void Button2::setMaxClicks(uint8_t clicks) {
+  max_clicks = clicks;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint8_t Button2::getMaxClicks() const {
+  return max_clicks;
 }
 
 /////////////////////////////////////////////////////////////////
 
 unsigned int Button2::getDebounceTime() const {
-  return debounce_time_ms;
+  return debounce_time_ms / BUTTON2_TIME_PER_MS;
+}
+
+/////////////////////////////////////////////////////////////////
+
+unsigned int Button2::getReleaseDebounceTime() const {
+  return release_debounce_ms / BUTTON2_TIME_PER_MS;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Measures the bounce trains of the input: edges less than
+// BTN_BOUNCE_GAP_MS apart form one train, all but its first edge count
+// as rejected. A clean edge is no train. The numbers are kept in
+// `stats`, which must outlive the button (NULL stops it). With
+// auto_tune the debounce time follows the trains: after
+// BTN_AUTOTUNE_MIN_TRAINS it is set to the mean plus four mean
+// deviations (about the 99.9th percentile) plus 1ms, never below
+// `min_ms` nor above the debounce time set now. Needs an extension,
+// returns false without one (see setExtension()).
+bool Button2::setBounceStats(ButtonBounceStats* stats, bool auto_tune /* = false */, unsigned int min_ms /* = BTN_AUTOTUNE_MIN_MS */) {
+  if (extension == nullptr) return false;
+  extension->bounce_stats = stats;
+  if (stats == nullptr) return true;
+  stats->open = false;
+  stats->tune_limit = auto_tune ? debounce_time_ms : 0;
+  stats->tune_floor = min_ms * BUTTON2_TIME_PER_MS;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint16_t Button2::getBounceTrains() const {
+  const ButtonBounceStats* s = _bounceStats();
+  return (s != nullptr) ? s->trains : 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint16_t Button2::getRejectedEdges() const {
+  const ButtonBounceStats* s = _bounceStats();
+  return (s != nullptr) ? s->rejected : 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Smoothed length of the bounce trains in clock units
+unsigned long Button2::getBounceTime() const {
+  const ButtonBounceStats* s = _bounceStats();
+  return (s != nullptr) ? s->smoothed >> 3 : 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+unsigned long Button2::getBounceDeviation() const {
+  const ButtonBounceStats* s = _bounceStats();
+  return (s != nullptr) ? s->deviation >> 2 : 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+unsigned long Button2::getLongestBounce() const {
+  const ButtonBounceStats* s = _bounceStats();
+  return (s != nullptr) ? s->longest : 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+ButtonBounceStats* Button2::_bounceStats() const {
+  return (extension != nullptr) ? extension->bounce_stats : nullptr;
+}
+
+/////////////////////////////////////////////////////////////////
+
+debounceMode Button2::getDebounceMode() const {
+  return (debounceMode)debounce_mode;
 }
 
 /////////////////////////////////////////////////////////////////
 
 unsigned int Button2::getLongClickTime() const {
-  return longclick_time_ms;
+  return longclick_time_ms / BUTTON2_TIME_PER_MS;
 }
 
 /////////////////////////////////////////////////////////////////
 
 unsigned int Button2::getLongClickInterval() const {
-  return longclick_interval_ms;
+  return longclick_interval_ms / BUTTON2_TIME_PER_MS;
 }
 
 /////////////////////////////////////////////////////////////////
 
 unsigned int Button2::getDoubleClickTime() const {
-  return doubleclick_time_ms;
+  return doubleclick_time_ms / BUTTON2_TIME_PER_MS;
 }
 
 /////////////////////////////////////////////////////////////////
@@ -138,7 +325,30 @@ void Button2::setReleasedHandler(CallbackFunction f) {
 /////////////////////////////////////////////////////////////////
 
 void Button2::setClickHandler(CallbackFunction f) {
-  click_cb = BUTTON2_MOVE(f);
+  click_cbs[0] = BUTTON2_MOVE(f);
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Handler for exactly `clicks` clicks, e.g. setClickHandler(4, f).
+// 1 to 3 are the single, double and triple click handlers. Returns
+// false if `clicks` is above BUTTON2_MAX_CLICK_HANDLERS (default 3).
+bool Button2::setClickHandler(uint8_t clicks, CallbackFunction f) {
+  if (clicks == 0 || clicks > BUTTON2_MAX_CLICK_HANDLERS) return false;
+  click_cbs[clicks - 1] = BUTTON2_MOVE(f);
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Catch-all for click counts up to max_clicks that have no handler
+// of their own. Use getNumberOfClicks() inside to tell them apart.
+// Kept in the extension, returns false without one (see setExtension()).
+bool Button2::setMultiClickHandler(CallbackFunction f, uint8_t max_clicks) {
+  if (extension == nullptr) return false;
+  extension->multi_cb = BUTTON2_MOVE(f);
+  extension->multi_max_clicks = max_clicks;
+  return true;
 }
 
 /////////////////////////////////////////////////////////////////
@@ -163,7 +373,68 @@ void Button2::setLongClickDetectedRetriggerable(bool retriggerable) {
 
 void Button2::setLongClickDetectedRetriggerable(bool retriggerable, unsigned int retrigger_ms) {
   longclick_retriggerable = retriggerable;
-  longclick_interval_ms = retrigger_ms;
+  longclick_interval_ms = retrigger_ms * BUTTON2_TIME_PER_MS;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Retriggered long clicks within `ms` of the last call of the detected
+// handler are passed on with the next call, getLongClickRepeats() tells
+// how many detections a call stands for. 0 (default) calls it each time.
+// Kept in the extension, returns false without one (see setExtension()).
+bool Button2::setLongClickCoalesceTime(unsigned int ms) {
+  if (extension == nullptr) return false;
+  extension->longclick_coalesce_ms = ms * BUTTON2_TIME_PER_MS;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+unsigned int Button2::getLongClickCoalesceTime() const {
+  return (extension != nullptr) ? extension->longclick_coalesce_ms / BUTTON2_TIME_PER_MS : 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Caps the handler calls of this button: up to `burst` events at once,
+// then one per `interval_ms`. Only the derived events (tap, clicks,
+// long clicks) are limited. Events over the limit are dropped and
+// counted by getThrottledEvents(), the click detection itself is not
+// affected. interval_ms = 0 turns the limit off. The bucket is kept in
+// the extension, returns false without one (see setExtension()).
+bool Button2::setRateLimit(uint8_t burst, unsigned int interval_ms) {
+  if (extension == nullptr) return false;
+  ButtonRateLimit &limit = extension->rate_limit;
+  limit.interval_ms = interval_ms * BUTTON2_TIME_PER_MS;
+  limit.burst = burst;
+  limit.tokens = burst;
+  limit.throttled = 0;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Same as setRateLimit(), for the events of all buttons together
+void Button2::setGlobalRateLimit(uint8_t burst, unsigned int interval_ms) {
+  _global_limit.interval_ms = interval_ms * BUTTON2_TIME_PER_MS;
+  _global_limit.burst = burst;
+  _global_limit.tokens = burst;
+  _global_limit.throttled = 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Events of this button dropped by its own or the global limit,
+// counted once it has an extension (setExtension())
+uint16_t Button2::getThrottledEvents() const {
+  return (extension != nullptr) ? extension->rate_limit.throttled : 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Events of all buttons dropped by the global limit
+uint16_t Button2::getGlobalThrottledEvents() {
+  return _global_limit.throttled;
 }
 
 /////////////////////////////////////////////////////////////////
@@ -174,21 +445,35 @@ void Button2::setLongClickDetectedHandler(CallbackFunction f) {
 
 /////////////////////////////////////////////////////////////////
 
+void Button2::setEventHandler(EventCallbackFunction f) {
+  event_cb = BUTTON2_MOVE(f);
+}
+
+/////////////////////////////////////////////////////////////////
+
 void Button2::setDoubleClickHandler(CallbackFunction f) {
-  double_cb = BUTTON2_MOVE(f);
+  click_cbs[1] = BUTTON2_MOVE(f);
 }
 
 /////////////////////////////////////////////////////////////////
 
 void Button2::setTripleClickHandler(CallbackFunction f) {
-  triple_cb = BUTTON2_MOVE(f);
+  click_cbs[2] = BUTTON2_MOVE(f);
 }
 
 /////////////////////////////////////////////////////////////////
 
 unsigned int Button2::wasPressedFor() const {
+  return down_time_ms / BUTTON2_TIME_PER_MS;
+}
+
+/////////////////////////////////////////////////////////////////
+
+#ifdef BUTTON2_USE_MICROS
+unsigned long Button2::wasPressedForUs() const {
   return down_time_ms;
 }
+#endif
 
 /////////////////////////////////////////////////////////////////
 
@@ -216,6 +501,169 @@ clickType Button2::getType() const {
 
 /////////////////////////////////////////////////////////////////
 
+// Lock-free, consistent copy of the state queried by isPressed(),
+// wasPressed(), getNumberOfClicks(), getType(), wasPressedFor() and
+// getLongClickCount(). Safe to call from another thread or core while
+// loop() runs, and from the handlers; the reader retries instead of
+// blocking the writer.
+ButtonSnapshot Button2::getSnapshot() const {
+  ButtonSnapshot snap;
+  button2_seq_t seq1, seq2;
+  do {
+    seq1 = BUTTON2_LOAD(snap_seq);
+    BUTTON2_FENCE_ACQUIRE();
+    snap.pressed_for = BUTTON2_LOAD(down_time_ms) / BUTTON2_TIME_PER_MS;
+    snap.longclick_count = BUTTON2_LOAD(longclick_counter);
+    snap.clicks = BUTTON2_LOAD(last_click_count);
+    snap.type = BUTTON2_LOAD(last_click_type);
+    snap.pressed = (BUTTON2_LOAD(state) == _pressedState);
+    snap.was_pressed = BUTTON2_LOAD(was_pressed);
+    BUTTON2_FENCE_ACQUIRE();
+    seq2 = BUTTON2_LOAD(snap_seq);
+  // odd: a write is in progress
+  } while ((seq1 & 1) || seq1 != seq2);
+  return snap;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Writer side of the seqlock, only on the thread that calls loop():
+// the sequence is odd while the fields read by getSnapshot() change.
+// Kept to the stores themselves, never around a handler call, so a
+// reader does not wait for a handler and a handler can read it.
+void Button2::_beginUpdate() {
+  BUTTON2_STORE(snap_seq, (button2_seq_t)(snap_seq + 1));
+  BUTTON2_FENCE_RELEASE();
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2::_endUpdate() {
+  BUTTON2_FENCE_RELEASE();
+  BUTTON2_STORE(snap_seq, (button2_seq_t)(snap_seq + 1));
+}
+
+/////////////////////////////////////////////////////////////////
+
+ButtonEventFilter Button2::on(buttonEvent ev) {
+  ButtonEventFilter f = { this, (uint16_t)(1U << ev) };
+  return f;
+}
+
+/////////////////////////////////////////////////////////////////
+
+ButtonEventFilter Button2::nextClick() {
+  return on(click_event);
+}
+
+/////////////////////////////////////////////////////////////////
+
+ButtonEventFilter Button2::doubleClick() {
+  return on(double_click_event);
+}
+
+/////////////////////////////////////////////////////////////////
+
+ButtonEventFilter Button2::tripleClick() {
+  return on(triple_click_event);
+}
+
+/////////////////////////////////////////////////////////////////
+
+ButtonEventFilter Button2::longClick() {
+  return on(long_click_event);
+}
+
+/////////////////////////////////////////////////////////////////
+
+unsigned long Button2::timeToNextDeadline() const {
+  return timeToNextDeadline(_now());
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Time in ms until loop() has to run again for a timing decision
+// (debounce, long click, end of the multi-click window), 0 if it is
+// due now, or BTN_NO_DEADLINE if only the next edge can change
+// anything. Allows event-driven callers to sleep instead of polling.
+// `now` is a reading of the button's clock (see setTimeFunction()),
+// i.e. the tick clock with BUTTON2_TICK_MS, micros() with
+// BUTTON2_USE_MICROS. The result is in ms, rounded up.
+unsigned long Button2::timeToNextDeadline(unsigned long now) const {
+  if (pin == BTN_UNDEFINED_PIN) return BTN_NO_DEADLINE;
+
+  // an edge the debounce filter has not passed on yet
+  unsigned long filter = _debounceDeadline(now);
+  unsigned long next = BTN_NO_DEADLINE;
+
+  if (state == _pressedState) {
+    // deadlines as offsets to down_ms, safe across clock overflow
+    unsigned long offset = BTN_NO_DEADLINE;
+    if (!pressed_triggered) offset = debounce_time_ms;
+
+    // a press that is not validated yet will be the first click
+    uint8_t clicks = pressed_triggered ? click_count : click_count + 1;
+    bool long_click_pending = (longclick_detected_cb != BUTTON2_NULL || _hasEventHandler()) && !longclick_reported;
+    if (long_click_pending && clicks == 1) {
+      unsigned long interval = (longclick_interval_ms > 0) ? longclick_interval_ms : longclick_time_ms;
+      unsigned long long_offset = (unsigned long)longclick_time_ms + ((unsigned long)longclick_counter * interval);
+      if (long_offset < offset) offset = long_offset;
+    }
+    if (offset != BTN_NO_DEADLINE) {
+      unsigned long elapsed = _elapsed(down_ms, now);
+      next = (elapsed >= offset) ? 0 : offset - elapsed;
+    }
+
+  // released: the clicks are reported once the window has passed
+  } else if (click_count > 0) {
+    unsigned long window = (unsigned long)doubleclick_time_ms + 1;
+    unsigned long elapsed = _elapsed(click_ms, now);
+    next = (elapsed >= window) ? 0 : window - elapsed;
+  }
+  if (filter < next) next = filter;
+  if (next == BTN_NO_DEADLINE) return next;
+  return (next + BUTTON2_TIME_PER_MS - 1) / BUTTON2_TIME_PER_MS;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// The button's clock: the value loop() uses as `now`, see feed().
+unsigned long Button2::getTime() const {
+  return _now();
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Time of the edge behind the current state, e.g. the release for a
+// click: the first raw edge of the bounce train that led to it, i.e.
+// the first one after the input was quiet for the debounce time. So
+// the latency includes the debounce wait in all modes.
+unsigned long Button2::getEdgeTime() const {
+  return state_edge_ms;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Time the handlers of the last event were called. The difference to
+// getEdgeTime() is the latency of the event, e.g. the debounce time
+// for a press, or the double click wait for a click.
+unsigned long Button2::getEventTime() const {
+  return event_ms;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Time the last event became due: the end of the debounce wait for a
+// press or release, the hold time for a long click detection, the end
+// of the double click window for a click. Events are called at this
+// time unless loop() runs late; getEventTime() minus this is that
+// delay, this minus getEdgeTime() the wait built into the event.
+unsigned long Button2::getEventDueTime() const {
+  return due_ms;
+}
+
+/////////////////////////////////////////////////////////////////
+
 int Button2::getID() const {
   return id;
 }
@@ -256,16 +704,18 @@ bool Button2::wasPressed() const {
 /////////////////////////////////////////////////////////////////
 
 void Button2::resetPressedState() {
-  was_pressed = false;
-  last_click_type = clickType::empty;
-  last_click_count = 0;
+  _beginUpdate();
+  BUTTON2_STORE(was_pressed, false);
+  BUTTON2_STORE(last_click_type, clickType::empty);
+  BUTTON2_STORE(last_click_count, (uint8_t)0);
+  BUTTON2_STORE(longclick_counter, (uint16_t)0);
+  _endUpdate();
   click_count = 0;
   click_ms = 0;
   down_ms = 0;
   pressed_triggered = false;
   longclick_detected = false;
   longclick_reported = false;
-  longclick_counter = 0;
 }
 
 
@@ -273,12 +723,30 @@ void Button2::resetPressedState() {
 
 uint8_t Button2::resetClickCount() {
   uint8_t tmp = last_click_count;
-  last_click_count = 0;
+  _beginUpdate();
+  BUTTON2_STORE(last_click_count, (uint8_t)0);
+  _endUpdate();
   return tmp;
 }
 
 /////////////////////////////////////////////////////////////////
 
+// Drops the click sequence in progress: no click, multi-click or long
+// click handler is called for it, the press/release handlers are not
+// affected. Used e.g. by Button2Combo for buttons that formed a chord.
+void Button2::cancelClicks() {
+  _beginUpdate();
+  BUTTON2_STORE(longclick_counter, (uint16_t)0);
+  _endUpdate();
+  longclick_fired = 0;
+  click_count = 0;
+  longclick_detected = false;
+  // no long click detection for the rest of this press
+  longclick_reported = true;
+}
+
+/////////////////////////////////////////////////////////////////
+
 clickType Button2::read(bool keepState /* = false */) {
   if (keepState) return last_click_type;
 
@@ -290,54 +758,188 @@ clickType Button2::read(bool keepState /* = false */) {
 /////////////////////////////////////////////////////////////////
 
 clickType Button2::wait(bool keepState /* = false */) {
-  while (!wasPressed()) {
-    loop();
-  }
-  return read(keepState);
+  return wait(keepState, BTN_WAIT_FOREVER);
 }
 
 /////////////////////////////////////////////////////////////////
 
 void Button2::waitForClick(bool keepState /* = false */) {
-  do {
-    while (!wasPressed()) {
-      loop();
-    }
-  } while (read(keepState) != single_click);
+  _waitFor(single_click, keepState, BTN_WAIT_FOREVER);
 }
 
 /////////////////////////////////////////////////////////////////
 
 void Button2::waitForDouble(bool keepState /* = false */) {
-  do {
-    while (!wasPressed()) {
-      loop();
-    }
-  } while (read(keepState) != double_click);
+  _waitFor(double_click, keepState, BTN_WAIT_FOREVER);
 }
 
 /////////////////////////////////////////////////////////////////
 
 void Button2::waitForTriple(bool keepState /* = false */) {
-  do {
-    while (!wasPressed()) {
-      loop();
-    }
-  } while (read(keepState) != triple_click);
+  _waitFor(triple_click, keepState, BTN_WAIT_FOREVER);
 }
 
 /////////////////////////////////////////////////////////////////
 
 void Button2::waitForLong(bool keepState /* = false */) {
-  do {
-    while (!wasPressed()) {
-      loop();
+  _waitFor(long_click, keepState, BTN_WAIT_FOREVER);
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Returns clickType::empty if nothing was clicked within timeout_ms.
+clickType Button2::wait(bool keepState, unsigned long timeout_ms) {
+  if (!_waitFor(clickType::empty, true, timeout_ms)) return clickType::empty;
+  return read(keepState);
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2::waitForClick(bool keepState, unsigned long timeout_ms) {
+  return _waitFor(single_click, keepState, timeout_ms);
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2::waitForDouble(bool keepState, unsigned long timeout_ms) {
+  return _waitFor(double_click, keepState, timeout_ms);
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2::waitForTriple(bool keepState, unsigned long timeout_ms) {
+  return _waitFor(triple_click, keepState, timeout_ms);
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2::waitForLong(bool keepState, unsigned long timeout_ms) {
+  return _waitFor(long_click, keepState, timeout_ms);
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Waits until `type` was clicked (any click for clickType::empty).
+// Between two loop() calls it sleeps until the next deadline, at
+// most BTN_WAIT_POLL_MS, so the pin is still sampled for new edges.
+// The timeout is measured on the button's clock, like the clicks.
+bool Button2::_waitFor(clickType type, bool keepState, unsigned long timeout_ms) {
+  button2_time_t last = _now();
+  unsigned long elapsed = 0;
+  while (true) {
+    loop();
+    if (wasPressed()) {
+      if (type == clickType::empty) return true;
+      if (read(keepState) == type) return true;
+    }
+
+    elapsed += _msSince(last);
+    if (timeout_ms != BTN_WAIT_FOREVER && elapsed >= timeout_ms) return false;
+
+    unsigned long ms = timeToNextDeadline();
+    if (ms > BTN_WAIT_POLL_MS) ms = BTN_WAIT_POLL_MS;
+    if (timeout_ms != BTN_WAIT_FOREVER && ms > timeout_ms - elapsed) ms = timeout_ms - elapsed;
+    if (ms > 0) _sleep(ms);
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Waits for a click on any of the buttons and returns the first one
+// that was pressed (its state is kept for read()), or NULL on timeout.
+// The timeout is measured on the clock of the first button.
+Button2* Button2::waitAny(Button2* buttons[], uint8_t count, unsigned long timeout_ms /* = BTN_WAIT_FOREVER */) {
+  if (count == 0) return NULL;
+  button2_time_t last = buttons[0]->_now();
+  unsigned long elapsed = 0;
+  while (true) {
+    unsigned long ms = BTN_WAIT_POLL_MS;
+    for (uint8_t i = 0; i < count; i++) {
+      buttons[i]->loop();
+      if (buttons[i]->wasPressed()) return buttons[i];
+      unsigned long next = buttons[i]->timeToNextDeadline();
+      if (next < ms) ms = next;
     }
-  } while (read(keepState) != long_click);
+
+    elapsed += buttons[0]->_msSince(last);
+    if (timeout_ms != BTN_WAIT_FOREVER && elapsed >= timeout_ms) return NULL;
+    if (timeout_ms != BTN_WAIT_FOREVER && ms > timeout_ms - elapsed) ms = timeout_ms - elapsed;
+    if (ms > 0) _sleep(ms);
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Whole ms on the button's clock since `last`, which is moved forward
+// by them. Summed up by the waits, so they outlast the 16 bit clock
+// of the tick mode and keep the fraction of a ms with micros().
+unsigned long Button2::_msSince(button2_time_t &last) const {
+  unsigned long ms = _elapsed(last, _now()) / BUTTON2_TIME_PER_MS;
+  last += ms * BUTTON2_TIME_PER_MS;
+  return ms;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Called by the wait functions instead of spinning, e.g. with
+// vTaskDelay(), std::this_thread::sleep_for() or a light sleep.
+// The hook may return early, the waits simply sample again.
+void Button2::setSleepFunction(SleepCallbackFunction f) {
+  _sleep_cb = BUTTON2_MOVE(f);
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Replaces millis() (micros() with BUTTON2_USE_MICROS) as the clock of
+// all buttons, e.g. a hardware timer or a clock shared with other code.
+// It must count in the same unit. Ignored with BUTTON2_TICK_MS.
+void Button2::setTimeFunction(TimeCallbackFunction f) {
+  _time_cb = BUTTON2_MOVE(f);
 }
 
 /////////////////////////////////////////////////////////////////
 
+// The clock set by setTimeFunction(), BUTTON2_NULL for millis(). Lets
+// code that replaces the clock for a while put the previous one back.
+Button2::TimeCallbackFunction Button2::getTimeFunction() {
+  return _time_cb;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Called after the handlers of every event of all buttons ran, with the
+// time the specific handler and the event handler took, each in
+// BUTTON2_PROFILE_CLOCK() units (us by default), or BTN_NOT_CALLED if
+// it is not set. Used by the instrumentation in Button2Stats.h. Only
+// costs time when set.
+void Button2::setDispatchHook(DispatchCallbackFunction f) {
+  _dispatch_hook = BUTTON2_MOVE(f);
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Called whenever the raw input of a button changes, before it is
+// debounced, with the new level and the time of the sample (the
+// button's clock). Used by Button2TraceRecorder in Button2Trace.h.
+void Button2::setTraceHook(TraceCallbackFunction f) {
+  _trace_hook = BUTTON2_MOVE(f);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2::_sleep(unsigned long ms) {
+  if (_sleep_cb != BUTTON2_NULL) {
+    _sleep_cb(ms);
+  } else {
+    delay(ms);
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Drops the handlers and the extension with the rate limit, bounce
+// statistics and click cadence. The context and the listeners are
+// kept, they belong to the application and the add-ons.
 void Button2::reset() {
   pin = BTN_UNDEFINED_PIN;
   longclick_retriggerable = false;
@@ -349,11 +951,30 @@ void Button2::reset() {
   released_cb = BUTTON2_NULL;
   change_cb = BUTTON2_NULL;
   tap_cb = BUTTON2_NULL;
-  click_cb = BUTTON2_NULL;
   long_cb = BUTTON2_NULL;
   longclick_detected_cb = BUTTON2_NULL;
-  double_cb = BUTTON2_NULL;
-  triple_cb = BUTTON2_NULL;
+  for (uint8_t i = 0; i < BUTTON2_MAX_CLICK_HANDLERS; i++) {
+    click_cbs[i] = BUTTON2_NULL;
+  }
+  event_cb = BUTTON2_NULL;
+  extension = nullptr;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Keeps the state of the features few buttons use in `ext`, which must
+// outlive the button (NULL drops it again): the multi click handler,
+// the rate limit, long click coalescing, the bounce statistics and the
+// click cadence. Set it before their setters, they return false
+// without it. A button without one doesn't carry their state.
+void Button2::setExtension(ButtonExtension* ext) {
+  extension = ext;
+}
+
+/////////////////////////////////////////////////////////////////
+
+ButtonExtension* Button2::getExtension() const {
+  return extension;
 }
 
 /////////////////////////////////////////////////////////////////
@@ -384,31 +1005,260 @@ void Button2::reset() {
 void Button2::loop() {
   if (pin == BTN_UNDEFINED_PIN) return;
 
+#ifdef BUTTON2_TICK_MS
+  ticks += BUTTON2_TICK_MS;
+#endif
+  _step(_getState(), _now());
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Processes a level that was sampled at `time` (a reading of the
+// button's clock, see getTime()) instead of reading the pin now.
+// Edges captured by an ISR or a sampling backend can be replayed in
+// order after loop() was blocked, the clicks are classified by the
+// time of the edges rather than by the time they are processed.
+void Button2::feed(uint8_t level, unsigned long time) {
+  if (pin == BTN_UNDEFINED_PIN) return;
+
+  // decisions that were due before the edge are made with the old level
+  if (level != raw_state) _catchUp(time);
+  _step(level, time);
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Lets the clock advance to `time` without a new sample, the input
+// keeps the level of the last loop() or feed().
+void Button2::advanceTo(unsigned long time) {
+  if (pin == BTN_UNDEFINED_PIN) return;
+
+  _catchUp(time);
+  _step(raw_state, time);
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Reads the pin and processes its level as sampled at `time`. Brings
+// the button back in line with the pin when edges were lost, e.g. by
+// a full Button2EdgeQueue.
+void Button2::resync(unsigned long time) {
+  if (pin == BTN_UNDEFINED_PIN) return;
+
+  feed(_getState(), time);
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Runs the timing decisions that were due by `now`, e.g. a retriggered
+// long click that was detected several times while loop() was blocked.
+void Button2::_catchUp(button2_time_t now) {
+  for (uint8_t i = 0; i < BTN_CATCHUP_STEPS && timeToNextDeadline(now) == 0; i++) {
+    _step(raw_state, now);
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2::_step(uint8_t raw, button2_time_t now) {
+  if (_trace_hook != BUTTON2_NULL && raw != raw_state) _trace_hook(*this, raw, now);
+  if (extension != nullptr && extension->bounce_stats != nullptr) _trackBounce(raw, now);
+  if (raw != raw_state) {
+    if (_elapsed(raw_edge_ms, now) >= debounce_time_ms) train_ms = now;
+    raw_edge_ms = now;
+  }
   prev_state = state;
-  state = _getState();
+  uint8_t level = _debounce(raw, now);
+  if (level != prev_state) {
+    state_edge_ms = train_ms;
+    _beginUpdate();
+    BUTTON2_STORE(state, level);
+    _endUpdate();
+  }
 
   if (state == _pressedState) {
-    _handlePress(millis());
+    _handlePress(now);
   } else {
-    _handleRelease(millis());
+    _handleRelease(now);
   }
 }
 
 /////////////////////////////////////////////////////////////////
 
-void Button2::_handlePress(unsigned long now) {
+// Called before _debounce(), raw_state still holds the previous sample.
+// A train ends once the input was quiet for BTN_BOUNCE_GAP_MS.
+void Button2::_trackBounce(uint8_t raw, button2_time_t now) {
+  ButtonBounceStats &s = *extension->bounce_stats;
+  bool quiet = _elapsed(s.last_edge, now) >= BTN_BOUNCE_GAP_MS * BUTTON2_TIME_PER_MS;
+  if (s.open && quiet) _endBounceTrain();
+  if (raw == raw_state) return;
+
+  if (s.open) {
+    if (s.rejected < 0xFFFF) s.rejected++;
+  } else {
+    s.first_edge = now;
+    s.open = true;
+  }
+  s.last_edge = now;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Adds the length of the train to the running mean and mean deviation
+// (gains 1/8 and 1/4), and tunes the debounce time if enabled
+void Button2::_endBounceTrain() {
+  ButtonBounceStats &s = *extension->bounce_stats;
+  s.open = false;
+  // a single edge did not bounce, it would pull the estimate to 0
+  if (s.last_edge == s.first_edge) return;
+  unsigned long len = _elapsed(s.first_edge, s.last_edge);
+
+  if (s.trains == 0) {
+    s.smoothed = len << 3;
+    s.deviation = len << 1;
+  } else {
+    long err = (long)len - (long)(s.smoothed >> 3);
+    s.smoothed += err;
+    s.deviation += (unsigned long)((err < 0) ? -err : err) - (s.deviation >> 2);
+  }
+  if (s.trains < 0xFFFF) s.trains++;
+  if (len > s.longest) s.longest = len;
+
+  if (s.tune_limit == 0 || s.trains < BTN_AUTOTUNE_MIN_TRAINS) return;
+  unsigned long safe = (s.smoothed >> 3) + s.deviation + BUTTON2_TIME_PER_MS;
+  if (safe < s.tune_floor) safe = s.tune_floor;
+  debounce_time_ms = (safe < s.tune_limit) ? safe : s.tune_limit;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Filters the raw input according to the debounce mode, returns the
+// state the click logic sees. The stable mode only filters releases
+// (if a release window is set), its press debounce is done by
+// _handlePress() and _releasedNow().
+uint8_t Button2::_debounce(uint8_t raw, button2_time_t now) {
+  uint8_t released = !_pressedState;
+
+  switch (debounce_mode) {
+    case debounce_lockout: {
+      raw_state = raw;
+      // the window starts with the last edge that was passed on
+      button2_duration_t window = (state == _pressedState) ? debounce_time_ms : _releaseDebounceTime();
+      if (raw == state || _elapsed(edge_ms, now) < window) return state;
+      edge_ms = now;
+      return raw;
+    }
+
+    case debounce_integrator: {
+      unsigned long dt = _elapsed(edge_ms, now);
+      edge_ms = now;
+      raw_state = raw;
+      bool is_pressed = (state == _pressedState);
+      // pressing fills the level up to the press window, releasing
+      // drains the release window that is left after a press
+      button2_duration_t top = is_pressed ? _releaseDebounceTime() : debounce_time_ms;
+      if (raw == _pressedState) {
+        debounce_level = (debounce_level >= top || dt >= (unsigned long)(top - debounce_level)) ? top : debounce_level + dt;
+      } else {
+        debounce_level = (dt >= debounce_level) ? 0 : debounce_level - dt;
+      }
+      if (!is_pressed && raw == _pressedState && debounce_level >= top) {
+        debounce_level = _releaseDebounceTime();
+        return _pressedState;
+      }
+      if (is_pressed && raw == released && debounce_level == 0) return released;
+      return state;
+    }
+
+    default:
+      if (raw != raw_state) {
+        raw_state = raw;
+        edge_ms = now;
+      }
+      if (raw == released && state == _pressedState && _elapsed(edge_ms, now) < release_debounce_ms) return state;
+      return raw;
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2::_resetDebounce() {
+  raw_state = state;
+  debounce_level = (state == _pressedState) ? _releaseDebounceTime() : 0;
+  // integrator: time of the last sample, else no edge within any window
+  edge_ms = _now();
+  raw_edge_ms = edge_ms - (button2_duration_t)-1;
+  if (debounce_mode != debounce_integrator) edge_ms = raw_edge_ms;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Time passed between two timestamps, safe across overflows
+// (also for 16 bit timestamps, which would be promoted to int)
+button2_time_t Button2::_elapsed(button2_time_t since, button2_time_t now) {
+  return now - since;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Clock of the click logic, see BUTTON2_TICK_MS and setTimeFunction()
+button2_time_t Button2::_now() const {
+#ifdef BUTTON2_TICK_MS
+  return ticks;
+#else
+  if (_time_cb != BUTTON2_NULL) return _time_cb();
+#ifdef BUTTON2_USE_MICROS
+  return micros();
+#else
+  return millis();
+#endif
+#endif
+}
+
+/////////////////////////////////////////////////////////////////
+
+button2_duration_t Button2::_releaseDebounceTime() const {
+  if (release_debounce_ms > 0 || debounce_mode == debounce_stable) return release_debounce_ms;
+  return debounce_time_ms;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Time until the debounce filter decides on a pending edge,
+// BTN_NO_DEADLINE if the raw input matches the state.
+unsigned long Button2::_debounceDeadline(button2_time_t now) const {
+  if (raw_state == state) return BTN_NO_DEADLINE;
+  unsigned long window;
+  if (debounce_mode == debounce_integrator) {
+    // more samples are needed, the level moves by the elapsed time
+    button2_duration_t top = (state == _pressedState) ? 0 : debounce_time_ms;
+    window = (top > debounce_level) ? top - debounce_level : debounce_level - top;
+  } else if (debounce_mode == debounce_lockout) {
+    window = (state == _pressedState) ? debounce_time_ms : _releaseDebounceTime();
+  } else {
+    window = release_debounce_ms;
+  }
+  unsigned long elapsed = _elapsed(edge_ms, now);
+  return (elapsed >= window) ? 0 : window - elapsed;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2::_handlePress(button2_time_t now) {
   // is it pressed now?
   if (prev_state != _pressedState) {
     _pressedNow(now);
-    return;
+    // the other modes pass on debounced edges only
+    if (debounce_mode == debounce_stable) return;
   }
 
   // Debouncing strategy: Wait for button to be pressed continuously
   // for debounce_time_ms BEFORE triggering the press event.
   // This filters out mechanical bounce on the press edge.
   if (!pressed_triggered) {
-    if (now - down_ms >= debounce_time_ms) {
+    if (debounce_mode != debounce_stable || _elapsed(down_ms, now) >= debounce_time_ms) {
       pressed_triggered = true;
+      due_ms = (debounce_mode == debounce_stable) ? down_ms + debounce_time_ms : now;
       _validKeypress();
     }
   }
@@ -430,21 +1280,22 @@ void Button2::_setID() {
 
 /////////////////////////////////////////////////////////////////
 
-void Button2::_handleRelease(unsigned long now) {
+void Button2::_handleRelease(button2_time_t now) {
   // is it released right now?
   if (prev_state == _pressedState) {
     _releasedNow(now);
     return;
   }
   // report click after double click time has passed
-  if (now - click_ms > doubleclick_time_ms) {
+  if (_elapsed(click_ms, now) > doubleclick_time_ms) {
+    due_ms = click_ms + doubleclick_time_ms + 1;
     _reportClicks();
   }
 }
 
 /////////////////////////////////////////////////////////////////
 
-void Button2::_pressedNow(unsigned long now) {
+void Button2::_pressedNow(button2_time_t now) {
   down_ms = now;
   pressed_triggered = false;
   click_ms = down_ms;
@@ -452,16 +1303,97 @@ void Button2::_pressedNow(unsigned long now) {
 
 /////////////////////////////////////////////////////////////////
 
+// Adds the gap between two presses (clock units) to the cadence. Gaps
+// longer than the configured double click time are separate clicks.
+// EWMA with a gain of 1/8: mean += d/8, var = 7/8 * (var + d^2/8)
+void Button2::_learnCadence(button2_time_t gap) {
+  ButtonClickCadence &c = *extension->cadence;
+  unsigned long ms = gap / BUTTON2_TIME_PER_MS;
+  if (ms > c.limit_ms) return;
+
+  if (c.samples == 0) {
+    c.mean = ms << 4;
+    c.variance = (ms / 2) * (ms / 2);
+  } else {
+    long diff = (long)(ms << 4) - (long)c.mean;
+    c.mean += diff / 8;
+    unsigned long d = ((diff < 0) ? -diff : diff) >> 4;
+    c.variance = (c.variance + d * d / 8) / 8 * 7;
+  }
+  if (c.samples < 0xFFFF) c.samples++;
+  _adaptDoubleClickTime();
+}
+
+/////////////////////////////////////////////////////////////////
+
+// z-score (* 100) of the normal distribution below which `percent` lie,
+// rounded up to the next tabulated value
+static uint16_t _zScore(uint8_t percent) {
+  if (percent <= 50) return 0;
+  if (percent <= 80) return 85;
+  if (percent <= 90) return 129;
+  if (percent <= 95) return 165;
+  if (percent <= 98) return 206;
+  if (percent <= 99) return 233;
+  return 310;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2::_adaptDoubleClickTime() {
+  const ButtonClickCadence &c = *extension->cadence;
+  if (c.samples < BTN_CADENCE_MIN_SAMPLES) return;
+
+  unsigned long window = ((c.mean + 15) >> 4) + (unsigned long)_zScore(c.percent) * _sqrt(c.variance) / 100 + 1;
+  if (window < BTN_DOUBLECLICK_MIN_MS) window = BTN_DOUBLECLICK_MIN_MS;
+  if (window > c.limit_ms) window = c.limit_ms;
+  doubleclick_time_ms = window * BUTTON2_TIME_PER_MS;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Integer square root, rounded down
+uint16_t Button2::_sqrt(uint32_t value) {
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+  while (bit > value) bit >>= 2;
+  while (bit != 0) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+/////////////////////////////////////////////////////////////////
+
 void Button2::_validKeypress() {
+  // a new sequence, clear what a cancelled one left behind
+  if (click_count == 0) {
+    longclick_detected = false;
+    longclick_reported = false;
+  }
   click_count++;
-  if (change_cb != BUTTON2_NULL) change_cb(*this);
-  if (pressed_cb != BUTTON2_NULL) pressed_cb(*this);
+  // the gap to the previous press, both past the debounce, so a bounce
+  // of the release is neither a gap nor the end of one
+  ButtonClickCadence* cadence = (extension != nullptr) ? extension->cadence : nullptr;
+  if (cadence != nullptr) {
+    if (cadence->after_click) _learnCadence(_elapsed((button2_time_t)cadence->last_press, down_ms));
+    cadence->last_press = down_ms;
+    cadence->after_click = true;
+  }
+  _fire(changed_event, change_cb);
+  _fire(pressed_event, pressed_cb);
 }
 
 /////////////////////////////////////////////////////////////////
 
-void Button2::_checkForLongClick(unsigned long now) {
-  if (longclick_detected_cb == BUTTON2_NULL) return;
+void Button2::_checkForLongClick(button2_time_t now) {
+  if (longclick_detected_cb == BUTTON2_NULL && !_hasEventHandler()) return;
   if (longclick_reported) return;
 
   // Long click detection timing calculation.
@@ -473,59 +1405,85 @@ void Button2::_checkForLongClick(unsigned long now) {
   // For example, during a double-click attempt, if the first click is held too long,
   // it becomes a long click and the sequence ends. Subsequent clicks in a multi-click
   // sequence do NOT trigger long click detection.
-  unsigned long interval = (longclick_interval_ms > 0) ? longclick_interval_ms : longclick_time_ms;
-  if (now - down_ms < ((unsigned long)longclick_time_ms + ((unsigned long)longclick_counter * interval))) return;
-
-  // Handle retriggerable long clicks (for continuous long press detection)
-  if (!longclick_retriggerable) {
+  // Kept in button2_time_t, i.e. 16 bit math in tick mode. The offset
+  // of a detection from down_ms has to fit the clock, so in tick mode
+  // retriggers end after a hold of about 65s (BTN_MAX_HOLD_MS).
+  button2_time_t interval = (longclick_interval_ms > 0) ? longclick_interval_ms : longclick_time_ms;
+  button2_time_t due = longclick_time_ms + (button2_time_t)((unsigned int)longclick_counter * interval);
+  if (_elapsed(down_ms, now) < due) return;
+
+  // Handle retriggerable long clicks (for continuous long press detection),
+  // up to the last detection that fits the clock
+  if (!longclick_retriggerable || due > (button2_time_t)-1 - interval) {
     longclick_reported = true;
   }
-  last_click_count = 1;
-  last_click_type = long_click;
-  longclick_counter++;
-  longclick_detected_cb(*this);
+  _beginUpdate();
+  BUTTON2_STORE(last_click_count, (uint8_t)1);
+  BUTTON2_STORE(last_click_type, long_click);
+  BUTTON2_STORE(longclick_counter, (uint16_t)(longclick_counter + 1));
+  _endUpdate();
+
+  // the first detection of a press is passed on right away, retriggers
+  // only once the coalesce time has passed since the last call
+  bool first = !longclick_detected;
+  if (first) longclick_fired = longclick_counter - 1;
+  unsigned long since_fired = (unsigned long)(uint16_t)(longclick_counter - longclick_fired) * interval;
+  due_ms = down_ms + due;
+  unsigned long coalesce_ms = (extension != nullptr) ? extension->longclick_coalesce_ms : 0;
+  if (first || since_fired >= coalesce_ms) _fireLongClickDetected();
   longclick_detected = true;
 }
 
 /////////////////////////////////////////////////////////////////
 
+void Button2::_fireLongClickDetected() {
+  longclick_repeats = longclick_counter - longclick_fired;
+  // a throttled call is passed on with the next one
+  if (_fire(longclick_detected_event, longclick_detected_cb)) longclick_fired = longclick_counter;
+}
+
+/////////////////////////////////////////////////////////////////
+
 uint16_t Button2::getLongClickCount() const {
   return longclick_counter;
 }
 
 /////////////////////////////////////////////////////////////////
 
+// Detections since the previous call of the long click detected
+// handler, > 1 if they were coalesced or throttled.
+uint16_t Button2::getLongClickRepeats() const {
+  return longclick_repeats;
+}
+
+/////////////////////////////////////////////////////////////////
+
 void Button2::_reportClicks() {
   // no click
   if (click_count == 0) return;
 
-  last_click_count = click_count;
-
-  // single or long press
-  if (click_count == 1) {
-    // long press
-    if (longclick_detected) {
-      last_click_type = long_click;
-      if (long_cb != BUTTON2_NULL) long_cb(*this);
-      longclick_counter = 0;
-    // single click
-    } else {
-      last_click_type = single_click;
-      if (click_cb != BUTTON2_NULL) click_cb (*this);
-    }
-
-  // double click
-  } else if (click_count == 2) {
-      last_click_type = double_click;
-      if (double_cb != BUTTON2_NULL) double_cb(*this);
-
-  // triple or x-clicks
+  // long press
+  bool longclick = (click_count == 1 && longclick_detected);
+  // single, double, triple or x-clicks: the types and events are in
+  // the same order, everything above 3 is reported as a triple click
+  uint8_t index = (click_count < 3) ? click_count - 1 : 2;
+
+  // the result is published before the handler runs
+  _beginUpdate();
+  BUTTON2_STORE(last_click_count, click_count);
+  BUTTON2_STORE(last_click_type, longclick ? long_click : (clickType)(single_click + index));
+  BUTTON2_STORE(was_pressed, true);
+  _endUpdate();
+
+  if (longclick) {
+    _fire(long_click_event, long_cb);
+    _beginUpdate();
+    BUTTON2_STORE(longclick_counter, (uint16_t)0);
+    _endUpdate();
   } else {
-      last_click_type = triple_click;
-      if (triple_cb != BUTTON2_NULL) triple_cb(*this);
+    _fire((buttonEvent)(click_event + index), _clickHandler(click_count));
   }
 
-  was_pressed = true;
   click_count = 0;
   click_ms = 0;
   longclick_detected = false;
@@ -534,25 +1492,200 @@ void Button2::_reportClicks() {
 
 /////////////////////////////////////////////////////////////////
 
-void Button2::_releasedNow(unsigned long now) {
-  down_time_ms = now - down_ms;
+// Single dispatch point for all handlers: calls the specific handler first,
+// then forwards the event to the generic event handler (if any) and
+// the listeners. Returns false if the event was dropped by a rate limit.
+// The limit applies to the derived events only, the state edges
+// (pressed, released, changed) are always passed on: combos and
+// mirrors of the pressed state rely on them.
+bool Button2::_fire(buttonEvent ev, CallbackFunction &cb) {
+  if (cb == BUTTON2_NULL && !_hasEventHandler()) return true;
+  if (ev >= tap_event && !_allowEvent()) {
+    if (extension != nullptr) extension->rate_limit.throttled++;
+    return false;
+  }
+  event_ms = _now();
+  if (_dispatch_hook != BUTTON2_NULL) {
+    unsigned long handler_time = BTN_NOT_CALLED;
+    unsigned long event_handler_time = BTN_NOT_CALLED;
+    if (cb != BUTTON2_NULL) {
+      unsigned long start = BUTTON2_PROFILE_CLOCK();
+      cb(*this);
+      handler_time = BUTTON2_PROFILE_CLOCK() - start;
+    }
+    if (event_cb != BUTTON2_NULL) {
+      unsigned long start = BUTTON2_PROFILE_CLOCK();
+      event_cb(*this, ev);
+      event_handler_time = BUTTON2_PROFILE_CLOCK() - start;
+    }
+    _dispatch_hook(*this, ev, handler_time, event_handler_time);
+  } else {
+    if (cb != BUTTON2_NULL) cb(*this);
+    if (event_cb != BUTTON2_NULL) event_cb(*this, ev);
+  }
+  // a listener may remove itself
+  for (Button2ListenerLink* l = listeners; l != nullptr; ) {
+    Button2ListenerLink* next = l->next;
+    l->listener->onButtonEvent(*this, ev);
+    l = next;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2::_hasEventHandler() const {
+  return event_cb != BUTTON2_NULL || listeners != nullptr;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Passes the events of this button to `listener`, after the handlers,
+// in the order the listeners were added. `link` is kept by the
+// listener, one per button it follows, and must not be in use.
+// Returns false if the listener already follows this button.
+bool Button2::addListener(Button2Listener &listener, Button2ListenerLink &link) {
+  if (link.button != nullptr) return false;
+  Button2ListenerLink** end = &listeners;
+  while (*end != nullptr) {
+    if ((*end)->listener == &listener) return false;
+    end = &(*end)->next;
+  }
+  link.button = this;
+  link.listener = &listener;
+  link.next = nullptr;
+  link.next_link = listener.links;
+  listener.links = &link;
+  *end = &link;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2::removeListener(Button2Listener &listener) {
+  Button2ListenerLink** at = &listeners;
+  while (*at != nullptr && (*at)->listener != &listener) at = &(*at)->next;
+  if (*at == nullptr) return;
+  Button2ListenerLink* link = *at;
+  *at = link->next;
+
+  Button2ListenerLink** own = &listener.links;
+  while (*own != link) own = &(*own)->next_link;
+  *own = link->next_link;
+  link->button = nullptr;
+  link->listener = nullptr;
+  link->next = nullptr;
+  link->next_link = nullptr;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Takes a token from the button's and the global bucket. The limit
+// applies to the time the handlers run, i.e. the clock now, also for
+// edges replayed by feed().
+bool Button2::_allowEvent() {
+  ButtonRateLimit* limit = (extension != nullptr) ? &extension->rate_limit : nullptr;
+  bool own = (limit != nullptr && limit->interval_ms != 0);
+  if (!own && _global_limit.interval_ms == 0) return true;
+
+  button2_time_t now = _now();
+  if (own && !_takeToken(*limit, now)) return false;
+  if (!_takeToken(_global_limit, now)) {
+    _global_limit.throttled++;
+    // give the button's token back
+    if (own) limit->tokens++;
+    return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2::_takeToken(ButtonRateLimit &bucket, button2_time_t now) {
+  if (bucket.interval_ms == 0) return true;
+
+  if (bucket.tokens < bucket.burst) {
+    unsigned long gained = _elapsed(bucket.refill_ms, now) / bucket.interval_ms;
+    if (gained >= (unsigned long)(bucket.burst - bucket.tokens)) {
+      bucket.tokens = bucket.burst;
+    } else {
+      bucket.tokens += gained;
+      bucket.refill_ms += gained * bucket.interval_ms;
+    }
+  }
+  // a full bucket does not fill up any further
+  if (bucket.tokens == bucket.burst) bucket.refill_ms = now;
+  if (bucket.tokens == 0) return false;
+  bucket.tokens--;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2::_releasedNow(button2_time_t now) {
+  _beginUpdate();
+  BUTTON2_STORE(down_time_ms, (button2_duration_t)_elapsed(down_ms, now));
+  _endUpdate();
 
   // Debouncing strategy (release edge): Reject presses that were
   // shorter than debounce_time_ms. This filters out mechanical bounce
   // on the release edge. Note: This is checked AFTER the release, whereas
   // the press debounce is checked BEFORE the press event is triggered.
   // This asymmetric approach provides robust debouncing on both edges.
-  if (down_time_ms < debounce_time_ms) return;
+  if (debounce_mode == debounce_stable && down_time_ms < debounce_time_ms) return;
+
+  // no gap is measured from a long click
+  if (extension != nullptr && extension->cadence != nullptr && down_time_ms >= longclick_time_ms) {
+    extension->cadence->after_click = false;
+  }
 
+  // also for the events resolved at the release
+  due_ms = (debounce_mode == debounce_stable) ? edge_ms + release_debounce_ms : now;
+
+  // pass on retriggers that were coalesced
+  if (longclick_detected && longclick_fired != longclick_counter) {
+    _fireLongClickDetected();
+    longclick_fired = longclick_counter;
+  }
   // trigger release
-  if (change_cb != BUTTON2_NULL) change_cb(*this);
-  if (released_cb != BUTTON2_NULL) released_cb(*this);
+  _fire(changed_event, change_cb);
+  _fire(released_event, released_cb);
   // trigger tap
-  if (tap_cb != BUTTON2_NULL) tap_cb(*this);
+  _fire(tap_event, tap_cb);
   // was it a longclick? (precedes single / double / triple clicks)
   if (down_time_ms >= longclick_time_ms) {
     longclick_detected = true;
   }
+  // early resolution: no further click can change the result
+  uint8_t max = _maxClicks();
+  if (max > 0 && (click_count >= max || longclick_detected)) {
+    _reportClicks();
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Highest click count that still matters, 0 = no limit.
+// The generic event handler is not taken into account.
+uint8_t Button2::_maxClicks() const {
+  if (max_clicks != BTN_MAX_CLICKS_AUTO) return max_clicks;
+  uint8_t max = 1;
+  for (uint8_t i = 1; i < BUTTON2_MAX_CLICK_HANDLERS; i++) {
+    if (click_cbs[i] != BUTTON2_NULL) max = i + 1;
+  }
+  if (extension != nullptr && extension->multi_cb != BUTTON2_NULL && extension->multi_max_clicks > max) max = extension->multi_max_clicks;
+  return max;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Handler for a click count: its own one, else the multi click
+// handler, else (as before) the triple click handler for more than
+// 3 clicks.
+Button2::CallbackFunction &Button2::_clickHandler(uint8_t clicks) {
+  if (clicks <= BUTTON2_MAX_CLICK_HANDLERS && click_cbs[clicks - 1] != BUTTON2_NULL) return click_cbs[clicks - 1];
+  if (extension != nullptr && extension->multi_cb != BUTTON2_NULL && clicks <= extension->multi_max_clicks) return extension->multi_cb;
+  return click_cbs[(clicks < 3) ? clicks - 1 : 2];
 }
 
 /////////////////////////////////////////////////////////////////
@@ -26,6 +26,64 @@
 
 #include <Arduino.h>
 
+// Highest click count with a handler of its own, see
+// setClickHandler(clicks, f). Each one costs a handler in every button,
+// raise it for 4 and more clicks.
+#ifndef BUTTON2_MAX_CLICK_HANDLERS
+#define BUTTON2_MAX_CLICK_HANDLERS 3
+#endif
+#if BUTTON2_MAX_CLICK_HANDLERS < 3
+#error "BUTTON2_MAX_CLICK_HANDLERS must be at least 3"
+#endif
+
+// Time base of the click logic. Define BUTTON2_TICK_MS (e.g. 5) when
+// loop() is called at a fixed rate, e.g. from a timer: each button then
+// counts its loop() calls instead of reading millis(), and keeps its
+// timestamps in 16 bits. Intervals longer than 65s wrap around.
+// Define BUTTON2_USE_MICROS to run it on micros() instead, for sub-ms
+// debounce windows and press durations. Timeouts are then kept in us,
+// timestamps in 32 bits like micros() on the targets, so the clock
+// wraps after ~71 minutes on 64 bit hosts too.
+#if defined(BUTTON2_TICK_MS) && defined(BUTTON2_USE_MICROS)
+#error "BUTTON2_TICK_MS and BUTTON2_USE_MICROS can't be combined"
+#endif
+#ifdef BUTTON2_TICK_MS
+  typedef uint16_t button2_time_t;
+#elif defined(BUTTON2_USE_MICROS)
+  typedef uint32_t button2_time_t;
+#else
+  typedef unsigned long button2_time_t;
+#endif
+#ifdef BUTTON2_USE_MICROS
+  typedef unsigned long button2_duration_t;
+  #define BUTTON2_TIME_PER_MS 1000UL
+#else
+  typedef unsigned int button2_duration_t;
+  #define BUTTON2_TIME_PER_MS 1U
+#endif
+
+// Clock of the handler times passed to the dispatch hook, see
+// setDispatchHook(). Can be replaced by a cycle counter.
+#ifndef BUTTON2_PROFILE_CLOCK
+  #define BUTTON2_PROFILE_CLOCK() micros()
+#endif
+
+// Memory ordering helpers for the snapshot seqlock (see getSnapshot()).
+// AVR is single core, there only the compiler must not reorder accesses.
+#if defined(__AVR__)
+  typedef uint8_t button2_seq_t;
+  #define BUTTON2_LOAD(v)          (*(volatile __typeof__(v) *)&(v))
+  #define BUTTON2_STORE(v, x)      (*(volatile __typeof__(v) *)&(v) = (x))
+  #define BUTTON2_FENCE_ACQUIRE()  __asm__ __volatile__("" ::: "memory")
+  #define BUTTON2_FENCE_RELEASE()  __asm__ __volatile__("" ::: "memory")
+#else
+  typedef uint16_t button2_seq_t;
+  #define BUTTON2_LOAD(v)          __atomic_load_n(&(v), __ATOMIC_RELAXED)
+  #define BUTTON2_STORE(v, x)      __atomic_store_n(&(v), (x), __ATOMIC_RELAXED)
+  #define BUTTON2_FENCE_ACQUIRE()  __atomic_thread_fence(__ATOMIC_ACQUIRE)
+  #define BUTTON2_FENCE_RELEASE()  __atomic_thread_fence(__ATOMIC_RELEASE)
+#endif
+
 // Define Arduino constants if not available (for testing environments).
 // Wrapped in #ifndef ARDUINO to avoid overriding platform-native types (e.g.
 // Arduino Pico defines INPUT_PULLUP etc. as a PinMode enum, not a macro;
@@ -55,6 +113,32 @@ const unsigned int BTN_DEBOUNCE_MS = 50;
 const unsigned int BTN_LONGCLICK_MS = 200;
 const unsigned int BTN_DOUBLECLICK_MS = 300;
 
+// returned by timeToNextDeadline() when only an edge can change the state
+const unsigned long BTN_NO_DEADLINE = (unsigned long)-1;
+// passed to the dispatch hook for a handler that is not set
+const unsigned long BTN_NOT_CALLED = (unsigned long)-1;
+// Longest hold the long click retriggers follow, the range of the
+// clock: about 65s in tick mode, 71min with micros()
+const unsigned long BTN_MAX_HOLD_MS = (button2_time_t)-1 / BUTTON2_TIME_PER_MS;
+// timeout for the wait functions, and their sampling interval
+const unsigned long BTN_WAIT_FOREVER = (unsigned long)-1;
+const unsigned int BTN_WAIT_POLL_MS = 5;
+// feed(): timing decisions made at most before a replayed edge
+const uint8_t BTN_CATCHUP_STEPS = 32;
+// setBounceStats(): edges closer than this belong to one bounce train,
+// trains needed before the debounce time is tuned, and the shortest
+// debounce time it is tuned to by default
+const unsigned int BTN_BOUNCE_GAP_MS = 20;
+const uint16_t BTN_AUTOTUNE_MIN_TRAINS = 8;
+const unsigned int BTN_AUTOTUNE_MIN_MS = 5;
+// setAdaptiveDoubleClick(): gaps needed before the window adapts, and
+// the shortest window it adapts to
+const uint16_t BTN_CADENCE_MIN_SAMPLES = 8;
+const unsigned int BTN_DOUBLECLICK_MIN_MS = 100;
+
+// setMaxClicks(): derive the limit from the registered handlers
+const uint8_t BTN_MAX_CLICKS_AUTO = 255;
+
 const unsigned int BTN_UNDEFINED_PIN = 255;
 const unsigned int BTN_VIRTUAL_PIN = 254;
 
@@ -68,6 +152,119 @@ enum clickType {
   empty
 };
 
+// Events reported to the generic event handler (one per handler type)
+enum buttonEvent {
+  pressed_event,
+  released_event,
+  changed_event,
+  tap_event,
+  click_event,
+  double_click_event,
+  triple_click_event,
+  long_click_event,
+  longclick_detected_event
+};
+
+const uint8_t BTN_EVENT_COUNT = 9;
+
+// Debounce strategies, see setDebounceMode()
+enum debounceMode {
+  debounce_stable,      // press counts once stable for the debounce time (default)
+  debounce_lockout,     // act on the first edge, then ignore edges for the debounce time
+  debounce_integrator   // integrate the samples, change state once the level saturates
+};
+
+// Consistent copy of the button state, see Button2::getSnapshot()
+struct ButtonSnapshot {
+  unsigned int pressed_for;   // wasPressedFor()
+  uint16_t longclick_count;   // getLongClickCount()
+  uint8_t clicks;             // getNumberOfClicks()
+  clickType type;             // getType()
+  bool pressed;               // isPressed()
+  bool was_pressed;           // wasPressed()
+};
+
+// Token bucket of setRateLimit(), kept in the ButtonExtension: `burst`
+// events at once, then one event per interval
+struct ButtonRateLimit {
+  button2_time_t refill_ms = 0;           // when the last token was added
+  button2_duration_t interval_ms = 0;     // clock units, 0 = no limit
+  uint16_t throttled = 0;                 // events dropped, getThrottledEvents()
+  uint8_t burst = 0;
+  uint8_t tokens = 0;
+};
+
+// Bounce trains of a button (first to last edge of a burst), see
+// setBounceStats(). Times in clock units, the mean and deviation are
+// smoothed like TCP's round trip time estimate.
+struct ButtonBounceStats {
+  unsigned long smoothed = 0;             // mean length * 8
+  unsigned long deviation = 0;            // mean deviation * 4
+  button2_time_t first_edge = 0;          // of the current train
+  button2_time_t last_edge = 0;
+  button2_duration_t longest = 0;
+  button2_duration_t tune_limit = 0;      // auto-tune: upper bound, 0 = off
+  button2_duration_t tune_floor = 0;      // auto-tune: lower bound
+  uint16_t trains = 0;
+  uint16_t rejected = 0;                  // edges after the first of a train
+  bool open = false;                      // a train is in progress
+};
+
+// Click cadence learned by setAdaptiveDoubleClick(): exponentially
+// weighted mean and variance of the gaps between the presses of a
+// multi click. Plain data with fixed-size fields, can be stored (e.g.
+// with EEPROM.put()) and passed in again after a reboot.
+struct ButtonClickCadence {
+  uint32_t mean = 0;          // ms * 16
+  uint32_t variance = 0;      // ms^2
+  uint32_t last_press = 0;    // of the last debounced press, clock units
+  uint16_t samples = 0;
+  uint16_t limit_ms = 0;      // the configured double click time
+  uint8_t percent = 0;        // share of the gaps the window captures
+  bool after_click = false;   // last_press was a short click, a gap can follow
+};
+
+class Button2;
+struct ButtonExtension;
+
+// Events of one button to wait for, co_await-able via Button2Coro.h
+struct ButtonEventFilter {
+  Button2* button;
+  uint16_t events;            // bit n = buttonEvent n
+};
+
+class Button2Listener;
+
+// Entry of a listener in the list of one button, see
+// Button2::addListener(). Kept by the listener, one per button it
+// follows.
+class Button2ListenerLink {
+  Button2* button = nullptr;
+  Button2Listener* listener = nullptr;
+  Button2ListenerLink* next = nullptr;        // next listener of the button
+  Button2ListenerLink* next_link = nullptr;   // next button of the listener
+  friend class Button2;
+  friend class Button2Listener;
+};
+
+// Receives the events of the buttons it was added to, after their own
+// handlers. Used by the add-ons to follow buttons without taking over
+// their event handler, a button can have any number of listeners.
+// Buttons without one are not affected. A listener leaves its buttons
+// when it is destroyed, a button its listeners. Add and remove them
+// while the buttons are not looped by another task.
+class Button2Listener {
+ public:
+  virtual void onButtonEvent(Button2 &btn, buttonEvent ev) = 0;
+
+ protected:
+  ~Button2Listener();
+
+ private:
+  Button2ListenerLink* links = nullptr;
+  friend class Button2;
+};
+
 class Button2 {
  protected:
   // Memory layout optimized for minimal padding
@@ -78,6 +275,11 @@ class Button2 {
   typedef std::function<uint8_t()> StateCallbackFunction;
   typedef std::function<uint8_t(const Button2 &btn)> StateCallbackFunctionBtn;
   typedef std::function<void()> InitCallbackFunction;
+  typedef std::function<void(Button2 &btn, buttonEvent ev)> EventCallbackFunction;
+  typedef std::function<void(unsigned long ms)> SleepCallbackFunction;
+  typedef std::function<unsigned long()> TimeCallbackFunction;
+  typedef std::function<void(Button2 &btn, buttonEvent ev, unsigned long handler_time, unsigned long event_handler_time)> DispatchCallbackFunction;
+  typedef std::function<void(Button2 &btn, uint8_t level, unsigned long time)> TraceCallbackFunction;
   #define BUTTON2_MOVE(v) std::move(v)
   #define BUTTON2_NULL nullptr
 #else
@@ -85,6 +287,11 @@ class Button2 {
   typedef uint8_t (*StateCallbackFunction)();
   typedef uint8_t (*StateCallbackFunctionBtn)(const Button2 &);
   typedef void (*InitCallbackFunction)();
+  typedef void (*EventCallbackFunction)(Button2 &, buttonEvent);
+  typedef void (*SleepCallbackFunction)(unsigned long);
+  typedef unsigned long (*TimeCallbackFunction)();
+  typedef void (*DispatchCallbackFunction)(Button2 &, buttonEvent, unsigned long, unsigned long);
+  typedef void (*TraceCallbackFunction)(Button2 &, uint8_t, unsigned long);
   #define BUTTON2_MOVE
   #define BUTTON2_NULL NULL
 #endif
@@ -96,26 +303,47 @@ class Button2 {
   CallbackFunction released_cb = BUTTON2_NULL;
   CallbackFunction change_cb = BUTTON2_NULL;
   CallbackFunction tap_cb = BUTTON2_NULL;
-  CallbackFunction click_cb = BUTTON2_NULL;
   CallbackFunction long_cb = BUTTON2_NULL;
   CallbackFunction longclick_detected_cb = BUTTON2_NULL;
-  CallbackFunction double_cb = BUTTON2_NULL;
-  CallbackFunction triple_cb = BUTTON2_NULL;
+  CallbackFunction click_cbs[BUTTON2_MAX_CLICK_HANDLERS] = {};  // indexed by clicks - 1
+  EventCallbackFunction event_cb = BUTTON2_NULL;
 
   // void* (4 bytes on 32-bit, 2 bytes on AVR — same size tier as function pointers)
+  // Optional state kept by the caller, only used once it is set
   void* context = nullptr;
+  ButtonExtension* extension = nullptr;
+  Button2ListenerLink* listeners = nullptr;
+
+  // button2_time_t (unsigned long, 2 bytes with BUTTON2_TICK_MS)
+  button2_time_t click_ms = 0;
+  button2_time_t down_ms = 0;
+  button2_time_t edge_ms = 0;       // last edge (stable, lockout) or sample (integrator)
+  button2_time_t raw_edge_ms = 0;   // last raw edge
+  button2_time_t train_ms = 0;      // first raw edge after a quiet input
+  button2_time_t state_edge_ms = 0; // train that led to the current state
+  button2_time_t event_ms = 0;      // dispatch of the last event
+  button2_time_t due_ms = 0;        // when the last event became due
+#ifdef BUTTON2_TICK_MS
+  button2_time_t ticks = 0;         // loop() calls * BUTTON2_TICK_MS
+#endif
 
-  // unsigned long (4 bytes on most platforms)
-  unsigned long click_ms = 0;
-  unsigned long down_ms = 0;
+  // button2_duration_t (unsigned int, 4 bytes with BUTTON2_USE_MICROS)
+  // timeouts in clock units: ms, or us with BUTTON2_USE_MICROS
+  button2_duration_t debounce_time_ms = BTN_DEBOUNCE_MS * BUTTON2_TIME_PER_MS;
+  button2_duration_t release_debounce_ms = 0;
+  button2_duration_t debounce_level = 0;
+  button2_duration_t longclick_time_ms = BTN_LONGCLICK_MS * BUTTON2_TIME_PER_MS;
+  button2_duration_t longclick_interval_ms = 0;
+  button2_duration_t doubleclick_time_ms = BTN_DOUBLECLICK_MS * BUTTON2_TIME_PER_MS;
+  button2_duration_t down_time_ms = 0;
 
   // unsigned int / uint16_t (2 bytes)
-  unsigned int debounce_time_ms = BTN_DEBOUNCE_MS;
-  unsigned int longclick_time_ms = BTN_LONGCLICK_MS;
-  unsigned int longclick_interval_ms = 0;
-  unsigned int doubleclick_time_ms = BTN_DOUBLECLICK_MS;
-  unsigned int down_time_ms = 0;
   uint16_t longclick_counter = 0;
+  uint16_t longclick_fired = 0;     // longclick_counter at the last detected handler call
+  uint16_t longclick_repeats = 0;
+
+  // Seqlock of getSnapshot(), odd while loop() stores the fields it reads
+  button2_seq_t snap_seq = 0;
 
   // int (2-4 bytes depending on platform)
   int id;
@@ -124,8 +352,11 @@ class Button2 {
   uint8_t pin;
   uint8_t state = HIGH;
   uint8_t prev_state = HIGH;
+  uint8_t raw_state = HIGH;
+  uint8_t debounce_mode = debounce_stable;
   uint8_t click_count = 0;
   uint8_t last_click_count = 0;
+  uint8_t max_clicks = 0;
   uint8_t _pressedState = LOW;
 
   // clickType (typically 1 byte enum)
@@ -138,36 +369,78 @@ class Button2 {
   bool longclick_reported = false;
   bool pressed_triggered = false;
 
-  void _handlePress(unsigned long now);
-  void _handleRelease(unsigned long now);
-  void _releasedNow(unsigned long now);
-  void _pressedNow(unsigned long now);
+  uint8_t _debounce(uint8_t raw, button2_time_t now);
+  void _resetDebounce();
+  button2_time_t _now() const;
+  button2_duration_t _releaseDebounceTime() const;
+  unsigned long _debounceDeadline(button2_time_t now) const;
+  void _handlePress(button2_time_t now);
+  void _handleRelease(button2_time_t now);
+  void _step(uint8_t raw, button2_time_t now);
+  void _catchUp(button2_time_t now);
+  ButtonBounceStats* _bounceStats() const;
+  void _trackBounce(uint8_t raw, button2_time_t now);
+  void _endBounceTrain();
+  void _learnCadence(button2_time_t gap);
+  void _adaptDoubleClickTime();
+  void _releasedNow(button2_time_t now);
+  void _pressedNow(button2_time_t now);
   void _validKeypress();
-  void _checkForLongClick(unsigned long now);
+  void _checkForLongClick(button2_time_t now);
+  void _fireLongClickDetected();
   void _reportClicks();
+  uint8_t _maxClicks() const;
+  CallbackFunction &_clickHandler(uint8_t clicks);
+  bool _fire(buttonEvent ev, CallbackFunction &cb);
+  bool _allowEvent();
+  void _beginUpdate();
+  void _endUpdate();
   void _setID();
 
  public:
   Button2();
   Button2(uint8_t attachTo, uint8_t buttonMode = INPUT_PULLUP, bool activeLow = true);
+  ~Button2();
 
   void begin(uint8_t attachTo, uint8_t buttonMode = INPUT_PULLUP, bool activeLow = true, InitCallbackFunction initCallback = BUTTON2_NULL);
 
   void setDebounceTime(unsigned int ms);
+  void setDebounceTime(unsigned int press_ms, unsigned int release_ms);
+  void setDebounceMode(debounceMode mode);
   void setLongClickTime(unsigned int ms);
   void setDoubleClickTime(unsigned int ms);
+  void setMaxClicks(uint8_t clicks);
+  bool setAdaptiveDoubleClick(ButtonClickCadence* learned, uint8_t percent = 95);
 
   void  setContext(void* ctx);
   void* getContext() const;
 
   unsigned int getDebounceTime() const;
+  unsigned int getReleaseDebounceTime() const;
+#ifdef BUTTON2_USE_MICROS
+  void setDebounceTimeUs(unsigned long press_us, unsigned long release_us = 0);
+  unsigned long wasPressedForUs() const;
+#endif
+  debounceMode getDebounceMode() const;
+
+  bool setBounceStats(ButtonBounceStats* stats, bool auto_tune = false, unsigned int min_ms = BTN_AUTOTUNE_MIN_MS);
+  uint16_t getBounceTrains() const;
+  uint16_t getRejectedEdges() const;
+  unsigned long getBounceTime() const;
+  unsigned long getBounceDeviation() const;
+  unsigned long getLongestBounce() const;
+
   unsigned int getLongClickTime() const;
   unsigned int getLongClickInterval() const;
   unsigned int getDoubleClickTime() const;
+  uint8_t getMaxClicks() const;
   uint8_t getPin() const;
 
   void reset();
 
+  void setExtension(ButtonExtension* ext);
+  ButtonExtension* getExtension() const;
+
   void setButtonStateFunction(StateCallbackFunction f);
   void setButtonStateFunction(StateCallbackFunctionBtn f);
 
@@ -179,18 +452,31 @@ class Button2 {
   void setClickHandler(CallbackFunction f);
   void setDoubleClickHandler(CallbackFunction f);
   void setTripleClickHandler(CallbackFunction f);
+  bool setClickHandler(uint8_t clicks, CallbackFunction f);
+  bool setMultiClickHandler(CallbackFunction f, uint8_t max_clicks);
 
   void setLongClickHandler(CallbackFunction f);
   void setLongClickDetectedHandler(CallbackFunction f);
+  void setEventHandler(EventCallbackFunction f);
+  bool addListener(Button2Listener &listener, Button2ListenerLink &link);
+  void removeListener(Button2Listener &listener);
 
   void setLongClickDetectedRetriggerable(bool retriggerable);
   void setLongClickDetectedRetriggerable(bool retriggerable, unsigned int retrigger_ms);
+  bool setLongClickCoalesceTime(unsigned int ms);
+  unsigned int getLongClickCoalesceTime() const;
+
+  bool setRateLimit(uint8_t burst, unsigned int interval_ms);
+  static void setGlobalRateLimit(uint8_t burst, unsigned int interval_ms);
+  uint16_t getThrottledEvents() const;
+  static uint16_t getGlobalThrottledEvents();
 
   unsigned int wasPressedFor() const;
   bool isPressed() const;
   bool isPressedRaw() const;
   void resetPressedState();
   uint8_t resetClickCount();
+  void cancelClicks();
 
   bool wasPressed() const;
   clickType read(bool keepState = false);
@@ -200,10 +486,31 @@ class Button2 {
   void waitForTriple(bool keepState = false);
   void waitForLong(bool keepState = false);
 
+  clickType wait(bool keepState, unsigned long timeout_ms);
+  bool waitForClick(bool keepState, unsigned long timeout_ms);
+  bool waitForDouble(bool keepState, unsigned long timeout_ms);
+  bool waitForTriple(bool keepState, unsigned long timeout_ms);
+  bool waitForLong(bool keepState, unsigned long timeout_ms);
+  static Button2* waitAny(Button2* buttons[], uint8_t count, unsigned long timeout_ms = BTN_WAIT_FOREVER);
+  static void setSleepFunction(SleepCallbackFunction f);
+  static void setTimeFunction(TimeCallbackFunction f);
+  static TimeCallbackFunction getTimeFunction();
+  static void setDispatchHook(DispatchCallbackFunction f);
+  static void setTraceHook(TraceCallbackFunction f);
+
   uint8_t getNumberOfClicks() const;
   uint16_t getLongClickCount() const;
+  uint16_t getLongClickRepeats() const;
 
   clickType getType() const;
+  ButtonSnapshot getSnapshot() const;
+  ButtonEventFilter on(buttonEvent ev);
+  ButtonEventFilter nextClick();
+  ButtonEventFilter doubleClick();
+  ButtonEventFilter tripleClick();
+  ButtonEventFilter longClick();
+  unsigned long timeToNextDeadline() const;
+  unsigned long timeToNextDeadline(unsigned long now) const;
   const char* clickToString(clickType type) const;
 
   int getID() const;
@@ -212,12 +519,48 @@ class Button2 {
   bool operator==(const Button2 &rhs) const;
 
   void loop();
+  void feed(uint8_t level, unsigned long time);
+  void advanceTo(unsigned long time);
+  void resync(unsigned long time);
+  unsigned long getTime() const;
+  unsigned long getEdgeTime() const;
+  unsigned long getEventTime() const;
+  unsigned long getEventDueTime() const;
 
  private:
   static uint8_t _nextID;
+  static SleepCallbackFunction _sleep_cb;
+  static TimeCallbackFunction _time_cb;
+  static DispatchCallbackFunction _dispatch_hook;
+  static TraceCallbackFunction _trace_hook;
+  static ButtonRateLimit _global_limit;
   uint8_t _getState() const;
+  bool _hasEventHandler() const;
+  bool _waitFor(clickType type, bool keepState, unsigned long timeout_ms);
+  unsigned long _msSince(button2_time_t &last) const;
+  static void _sleep(unsigned long ms);
+  static button2_time_t _elapsed(button2_time_t since, button2_time_t now);
+  static bool _takeToken(ButtonRateLimit &bucket, button2_time_t now);
+  static uint16_t _sqrt(uint32_t value);
+
+  friend struct ButtonExtension;
+};
 
+/////////////////////////////////////////////////////////////////
+
+// State of the features few buttons use, see Button2::setExtension():
+// the multi click handler, the rate limit, long click coalescing, and
+// the bounce statistics and click cadence. Kept by the caller, one per
+// button, so the other buttons don't carry it.
+struct ButtonExtension {
+  Button2::CallbackFunction multi_cb = BUTTON2_NULL;
+  ButtonRateLimit rate_limit;
+  ButtonBounceStats* bounce_stats = nullptr;
+  ButtonClickCadence* cadence = nullptr;
+  button2_duration_t longclick_coalesce_ms = 0;
+  uint8_t multi_max_clicks = 0;
 };
+
 /////////////////////////////////////////////////////////////////
 #endif
 /////////////////////////////////////////////////////////////////
@@ -0,0 +1,139 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Combo.cpp - Multi-button chords for Button2.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+*/
+/////////////////////////////////////////////////////////////////
+
+#include "Button2Combo.h"
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2Combo::add(Button2 &btn) {
+  if (button_count >= BUTTON2_COMBO_MAX_BUTTONS) return false;
+  if (!btn.addListener(*this, links[button_count])) return false;
+  buttons[button_count++] = &btn;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Bit of a button, combine them for addChord(): maskOf(a) | maskOf(b)
+uint16_t Button2Combo::maskOf(const Button2 &btn) const {
+  for (uint8_t i = 0; i < button_count; i++) {
+    if (buttons[i] == &btn) return (uint16_t)(1U << i);
+  }
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// hold_ms > 0: fires once the buttons are held together for hold_ms.
+// hold_ms = 0: fires when the buttons are released after being
+// pressed together.
+bool Button2Combo::addChord(uint16_t mask, ChordCallbackFunction f, unsigned int hold_ms /* = 0 */) {
+  if (chord_count >= BUTTON2_COMBO_MAX_CHORDS || mask == 0) return false;
+  Chord &c = chords[chord_count++];
+  c.mask = mask;
+  c.hold_ms = hold_ms;
+  c.cb = BUTTON2_MOVE(f);
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2Combo::setChordWindow(unsigned int ms) {
+  window_ms = ms;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Cancel the click sequences of the buttons that formed a chord,
+// so their own click handlers don't fire as well.
+void Button2Combo::setSuppressClicks(bool suppress_clicks) {
+  suppress = suppress_clicks;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint16_t Button2Combo::getPressedMask() const {
+  return pressed;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2Combo::loop() {
+  for (uint8_t i = 0; i < button_count; i++) {
+    buttons[i]->loop();
+  }
+  // hold chords: all of its buttons down, none released yet
+  if (pressed == 0 || pressed != peak || spoiled || fired) return;
+  Button2* last = buttons[changed_by];
+  unsigned long held_ms = (button2_time_t)(last->getTime() - changed_ms) / BUTTON2_TIME_PER_MS;
+  for (uint8_t i = 0; i < chord_count; i++) {
+    if (chords[i].hold_ms > 0 && chords[i].mask == pressed && held_ms >= chords[i].hold_ms) {
+      _fire(i);
+      return;
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+// The chord window and the hold time are measured between the edges
+// behind the press and release events, on the buttons' clock.
+void Button2Combo::onButtonEvent(Button2 &btn, buttonEvent ev) {
+  if (ev != pressed_event && ev != released_event) return;
+  uint8_t index = 0;
+  while (index < button_count && buttons[index] != &btn) index++;
+  if (index == button_count) return;
+  uint16_t bit = (uint16_t)(1U << index);
+  unsigned long now = btn.getEdgeTime();
+  changed_ms = now;
+  changed_by = index;
+
+  if (ev == released_event) {
+    pressed &= ~bit;
+    // click chords fire when the last button goes up
+    if (pressed != 0 || spoiled || fired) return;
+    for (uint8_t i = 0; i < chord_count; i++) {
+      if (chords[i].hold_ms == 0 && chords[i].mask == peak) {
+        _fire(i);
+        return;
+      }
+    }
+    return;
+  }
+
+  // first button of a new sequence
+  if (pressed == 0) {
+    first_press_ms = now;
+    peak = 0;
+    spoiled = false;
+    fired = false;
+  } else if ((button2_time_t)(now - first_press_ms) / BUTTON2_TIME_PER_MS > window_ms || pressed != peak) {
+    // too late, or pressed again after a release
+    spoiled = true;
+  }
+  pressed |= bit;
+  peak |= bit;
+  if (!suppress || spoiled || fired) return;
+
+  for (uint8_t i = 0; i < chord_count; i++) {
+    if (chords[i].mask != pressed) continue;
+    for (uint8_t b = 0; b < button_count; b++) {
+      if (pressed & (1U << b)) buttons[b]->cancelClicks();
+    }
+    return;
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2Combo::_fire(uint8_t chord) {
+  fired = true;
+  if (chords[chord].cb != BUTTON2_NULL) chords[chord].cb(chord);
+}
+
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,87 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Combo.h - Multi-button chords for Button2.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+
+  Keeps the debounced pressed state of a group of buttons as a
+  bitmask and matches it against registered chords, e.g. A+B held
+  for 1s or A+C clicked together. Matching is a mask comparison.
+*/
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef Button2Combo_h
+#define Button2Combo_h
+
+/////////////////////////////////////////////////////////////////
+
+#include "Button2.h"
+
+/////////////////////////////////////////////////////////////////
+
+#define BUTTON2_COMBO_MAX_BUTTONS 16
+
+#ifndef BUTTON2_COMBO_MAX_CHORDS
+#define BUTTON2_COMBO_MAX_CHORDS 8
+#endif
+
+// all buttons of a chord must be pressed within this time
+const unsigned int BTN_CHORD_WINDOW_MS = 200;
+
+/////////////////////////////////////////////////////////////////
+
+class Button2Combo : public Button2Listener {
+ protected:
+#ifdef BUTTON2_HAS_STD_FUNCTION
+  typedef std::function<void(uint8_t chord)> ChordCallbackFunction;
+#else
+  typedef void (*ChordCallbackFunction)(uint8_t);
+#endif
+
+  struct Chord {
+    ChordCallbackFunction cb;
+    unsigned int hold_ms;   // 0 = fires when released ("clicked together")
+    uint16_t mask;
+  };
+
+  Chord chords[BUTTON2_COMBO_MAX_CHORDS];
+  Button2* buttons[BUTTON2_COMBO_MAX_BUTTONS];
+  Button2ListenerLink links[BUTTON2_COMBO_MAX_BUTTONS];
+
+  // edge times on the buttons' clock
+  unsigned long first_press_ms = 0;
+  unsigned long changed_ms = 0;
+
+  unsigned int window_ms = BTN_CHORD_WINDOW_MS;
+  uint16_t pressed = 0;     // bit n = button n is pressed
+  uint16_t peak = 0;        // all buttons pressed since the first press
+
+  uint8_t button_count = 0;
+  uint8_t chord_count = 0;
+  uint8_t changed_by = 0;   // button of the last edge
+  bool spoiled = false;     // a button was pressed too late for a chord
+  bool fired = false;       // a chord fired in this sequence
+  bool suppress = false;
+
+  void onButtonEvent(Button2 &btn, buttonEvent ev) override;
+  void _fire(uint8_t chord);
+
+ public:
+  // The group listens to the buttons' events, their handlers stay free.
+  bool add(Button2 &btn);
+  uint16_t maskOf(const Button2 &btn) const;
+
+  bool addChord(uint16_t mask, ChordCallbackFunction f, unsigned int hold_ms = 0);
+  void setChordWindow(unsigned int ms);
+  void setSuppressClicks(bool suppress_clicks);
+
+  // Call instead of the buttons' loop()
+  void loop();
+  uint16_t getPressedMask() const;
+};
+
+/////////////////////////////////////////////////////////////////
+#endif
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,184 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Coro.cpp - C++20 coroutine layer for Button2.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+*/
+/////////////////////////////////////////////////////////////////
+
+#include "Button2Coro.h"
+
+#ifdef BUTTON2_HAS_CORO
+
+/////////////////////////////////////////////////////////////////
+
+Button2Executor* Button2Executor::_current = nullptr;
+
+/////////////////////////////////////////////////////////////////
+
+Button2Executor::Button2Executor() {
+  for (uint8_t i = 0; i < BUTTON2_CORO_MAX_TASKS; i++) {
+    slots[i].state = slot_free;
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+Button2Executor::~Button2Executor() {
+  for (uint8_t i = 0; i < BUTTON2_CORO_MAX_TASKS; i++) {
+    if (slots[i].state != slot_free) slots[i].handle.destroy();
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2Executor::add(Button2 &btn) {
+  if (button_count >= BUTTON2_CORO_MAX_BUTTONS) return false;
+  if (!btn.addListener(*this, links[button_count])) return false;
+  if (button_count == 0) clock_last = btn.getTime();
+  buttons[button_count++] = &btn;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// The task runs up to its first co_await on the next loop().
+bool Button2Executor::spawn(Button2Task task) {
+  for (uint8_t i = 0; i < BUTTON2_CORO_MAX_TASKS; i++) {
+    if (slots[i].state != slot_free) continue;
+    slots[i].handle = task.release();
+    slots[i].state = slot_ready;
+    return true;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Runs the buttons, then resumes every task whose event happened or
+// whose sleep expired. Events are only collected while the buttons
+// run, the tasks are resumed outside of Button2::loop().
+void Button2Executor::loop() {
+  for (uint8_t i = 0; i < button_count; i++) {
+    buttons[i]->loop();
+  }
+
+  unsigned long now = _clock();
+  Button2Executor* prev = _current;
+  _current = this;
+  for (uint8_t i = 0; i < BUTTON2_CORO_MAX_TASKS; i++) {
+    Slot &s = slots[i];
+    if (s.state == slot_waiting && s.sleeping && now - s.since_ms >= s.sleep_ms) {
+      s.state = slot_ready;
+    }
+    if (s.state != slot_ready) continue;
+
+    running = i;
+    s.handle.resume();
+    running = -1;
+    if (s.handle.done()) {
+      s.handle.destroy();
+      s.state = slot_free;
+    }
+  }
+  _current = prev;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Earliest time loop() has to run: button deadlines or a sleeping task.
+unsigned long Button2Executor::timeToNextDeadline() const {
+  unsigned long now = _clock();
+  unsigned long next = BTN_NO_DEADLINE;
+  for (uint8_t i = 0; i < button_count; i++) {
+    unsigned long t = buttons[i]->timeToNextDeadline();
+    if (t < next) next = t;
+  }
+  for (uint8_t i = 0; i < BUTTON2_CORO_MAX_TASKS; i++) {
+    const Slot &s = slots[i];
+    if (s.state == slot_ready) return 0;
+    if (s.state != slot_waiting || !s.sleeping) continue;
+    unsigned long elapsed = now - s.since_ms;
+    unsigned long t = (elapsed >= s.sleep_ms) ? 0 : s.sleep_ms - elapsed;
+    if (t < next) next = t;
+  }
+  return next;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint8_t Button2Executor::getTaskCount() const {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < BUTTON2_CORO_MAX_TASKS; i++) {
+    if (slots[i].state != slot_free) count++;
+  }
+  return count;
+}
+
+/////////////////////////////////////////////////////////////////
+
+Button2Executor* Button2Executor::current() {
+  return _current;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Parks the running task until one of the filters matches.
+bool Button2Executor::_suspend(const ButtonEventFilter* filters, uint8_t count, int8_t* index, buttonEvent* event) {
+  if (running < 0) return false;
+  Slot &s = slots[running];
+  s.filters = filters;
+  s.filter_count = count;
+  s.matched_index = index;
+  s.matched_event = event;
+  s.sleeping = false;
+  s.state = slot_waiting;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2Executor::_suspendFor(unsigned long ms) {
+  if (running < 0) return false;
+  Slot &s = slots[running];
+  s.filter_count = 0;
+  s.since_ms = _clock();
+  s.sleep_ms = ms;
+  s.sleeping = true;
+  s.state = slot_waiting;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// ms on the clock of the first button (millis() without buttons),
+// summed up so it outlasts the 16 bit clock of the tick mode
+unsigned long Button2Executor::_clock() const {
+  if (button_count == 0) return millis();
+  unsigned long passed = (button2_time_t)(buttons[0]->getTime() - clock_last) / BUTTON2_TIME_PER_MS;
+  clock_ms += passed;
+  clock_last += passed * BUTTON2_TIME_PER_MS;
+  return clock_ms;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Called from within Button2::loop(): only marks the tasks as ready,
+// the first matching event wins.
+void Button2Executor::onButtonEvent(Button2 &btn, buttonEvent ev) {
+  for (uint8_t i = 0; i < BUTTON2_CORO_MAX_TASKS; i++) {
+    Slot &s = slots[i];
+    if (s.state != slot_waiting || s.sleeping) continue;
+    for (uint8_t f = 0; f < s.filter_count; f++) {
+      if (s.filters[f].button != &btn || !(s.filters[f].events & (1U << ev))) continue;
+      *s.matched_index = f;
+      *s.matched_event = ev;
+      s.state = slot_ready;
+      break;
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+#endif
+/////////////////////////////////////////////////////////////////
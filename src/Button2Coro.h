@@ -0,0 +1,184 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Coro.h - C++20 coroutine layer for Button2.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+
+  Lets UI flows wait for button events with co_await, e.g.
+  co_await btn.nextClick() or co_await anyOf(a.longClick(), b.doubleClick()).
+  A single-threaded executor resumes the coroutines from its loop().
+  Requires -std=c++20 (or gnu++2a).
+*/
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef Button2Coro_h
+#define Button2Coro_h
+
+/////////////////////////////////////////////////////////////////
+
+#include "Button2.h"
+
+#ifndef BUTTON2_HAS_CORO
+#if defined(BUTTON2_HAS_STD_FUNCTION) && defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define BUTTON2_HAS_CORO 1
+#endif
+#endif
+#endif
+
+#ifdef BUTTON2_HAS_CORO
+
+#include <coroutine>
+#include <exception>
+
+/////////////////////////////////////////////////////////////////
+
+#ifndef BUTTON2_CORO_MAX_TASKS
+#define BUTTON2_CORO_MAX_TASKS 16
+#endif
+
+#ifndef BUTTON2_CORO_MAX_BUTTONS
+#define BUTTON2_CORO_MAX_BUTTONS 16
+#endif
+
+/////////////////////////////////////////////////////////////////
+// Coroutine type of a UI flow, started by Button2Executor::spawn()
+
+class Button2Task {
+ public:
+  struct promise_type {
+    Button2Task get_return_object() {
+      return Button2Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  explicit Button2Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+  Button2Task(Button2Task &&other) noexcept : handle(other.handle) { other.handle = nullptr; }
+  Button2Task(const Button2Task &) = delete;
+  Button2Task &operator=(const Button2Task &) = delete;
+  ~Button2Task() {
+    if (handle) handle.destroy();
+  }
+
+  std::coroutine_handle<> release() {
+    std::coroutine_handle<> h = handle;
+    handle = nullptr;
+    return h;
+  }
+
+ private:
+  std::coroutine_handle<promise_type> handle;
+};
+
+/////////////////////////////////////////////////////////////////
+// Single-threaded executor: owns the tasks and the button loop
+
+class Button2Executor : public Button2Listener {
+ protected:
+  enum slotState : uint8_t { slot_free, slot_ready, slot_waiting };
+
+  struct Slot {
+    std::coroutine_handle<> handle;
+    const ButtonEventFilter* filters;
+    int8_t* matched_index;
+    buttonEvent* matched_event;
+    unsigned long since_ms;
+    unsigned long sleep_ms;
+    uint8_t filter_count;
+    uint8_t state;
+    bool sleeping;
+  };
+
+  Slot slots[BUTTON2_CORO_MAX_TASKS];
+  Button2* buttons[BUTTON2_CORO_MAX_BUTTONS];
+  Button2ListenerLink links[BUTTON2_CORO_MAX_BUTTONS];
+  mutable unsigned long clock_ms = 0;
+  mutable button2_time_t clock_last = 0;
+  uint8_t button_count = 0;
+  int8_t running = -1;
+
+  static Button2Executor* _current;
+
+  void onButtonEvent(Button2 &btn, buttonEvent ev) override;
+  unsigned long _clock() const;
+
+ public:
+  Button2Executor();
+  ~Button2Executor();
+
+  // Add the buttons before spawning tasks that sleep, sleepFor() runs
+  // on the clock of the first button.
+  bool add(Button2 &btn);
+  bool spawn(Button2Task task);
+
+  void loop();
+  unsigned long timeToNextDeadline() const;
+  uint8_t getTaskCount() const;
+
+  // used by the awaitables, valid while a task runs
+  static Button2Executor* current();
+  bool _suspend(const ButtonEventFilter* filters, uint8_t count, int8_t* index, buttonEvent* event);
+  bool _suspendFor(unsigned long ms);
+};
+
+/////////////////////////////////////////////////////////////////
+// Awaitables
+
+// co_await anyOf(...) resumes with the index of the first filter
+// that matched, co_await on a single filter with the event.
+template <uint8_t N>
+struct Button2AnyAwaiter {
+  ButtonEventFilter filters[N];
+  int8_t index = -1;
+  buttonEvent event = pressed_event;
+
+  bool await_ready() const noexcept { return false; }
+  bool await_suspend(std::coroutine_handle<>) {
+    Button2Executor* exec = Button2Executor::current();
+    return exec != nullptr && exec->_suspend(filters, N, &index, &event);
+  }
+  int8_t await_resume() const noexcept { return index; }
+};
+
+struct Button2EventAwaiter : Button2AnyAwaiter<1> {
+  buttonEvent await_resume() const noexcept { return event; }
+};
+
+inline Button2EventAwaiter operator co_await(ButtonEventFilter f) {
+  Button2EventAwaiter a;
+  a.filters[0] = f;
+  return a;
+}
+
+// Named anyOf() to avoid clashes with std::any under "using namespace std"
+template <typename... Filters>
+Button2AnyAwaiter<sizeof...(Filters)> anyOf(Filters... f) {
+  return Button2AnyAwaiter<sizeof...(Filters)>{ { f... } };
+}
+
+// co_await sleepFor(ms), resumed by the executor's loop()
+struct Button2SleepAwaiter {
+  unsigned long ms;
+
+  bool await_ready() const noexcept { return ms == 0; }
+  bool await_suspend(std::coroutine_handle<>) {
+    Button2Executor* exec = Button2Executor::current();
+    return exec != nullptr && exec->_suspendFor(ms);
+  }
+  void await_resume() const noexcept {}
+};
+
+inline Button2SleepAwaiter sleepFor(unsigned long ms) {
+  return Button2SleepAwaiter{ ms };
+}
+
+/////////////////////////////////////////////////////////////////
+#endif
+#endif
+/////////////////////////////////////////////////////////////////
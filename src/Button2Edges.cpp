@@ -0,0 +1,73 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Edges.cpp - Timestamped edge queue for Button2.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+*/
+/////////////////////////////////////////////////////////////////
+
+#include "Button2Edges.h"
+
+#ifndef BUTTON2_TICK_MS
+
+/////////////////////////////////////////////////////////////////
+
+// Call before the ISR that pushes the edges is attached
+void Button2EdgeQueue::begin(Button2 &btn) {
+  button = &btn;
+  head = tail = 0;
+  dropped = resynced = 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Replays the queued edges with their own times, then lets the
+// button's clock catch up to now for the pending timing decisions.
+// After edges were dropped the queued levels may end on the wrong one
+// (e.g. the final release is lost), then the pin is read instead.
+void Button2EdgeQueue::loop() {
+  if (button == NULL) return;
+
+  unsigned long now = button->getTime();
+  uint8_t d = BUTTON2_LOAD(dropped);
+  uint8_t t = tail;
+  uint8_t h = BUTTON2_LOAD(head);
+  BUTTON2_FENCE_ACQUIRE();
+  bool replayed = (t != h);
+  unsigned long last = now;
+
+  while (t != h) {
+    Button2Edge edge = edges[t];
+    t = (t + 1) & (BUTTON2_EDGE_QUEUE_SIZE - 1);
+    // free the slot before the handlers run
+    BUTTON2_FENCE_RELEASE();
+    BUTTON2_STORE(tail, t);
+    button->feed(edge.level, edge.time);
+    last = edge.time;
+  }
+  // an edge pushed after `now` was read must not turn the clock back
+  if (replayed && (long)(last - now) > 0) now = last;
+  if (d != resynced) {
+    resynced = d;
+    button->resync(now);
+  } else {
+    button->advanceTo(now);
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint8_t Button2EdgeQueue::available() const {
+  return (BUTTON2_LOAD(head) - tail) & (BUTTON2_EDGE_QUEUE_SIZE - 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Modulo 256
+uint8_t Button2EdgeQueue::getDroppedEdges() const {
+  return BUTTON2_LOAD(dropped);
+}
+
+/////////////////////////////////////////////////////////////////
+#endif
+/////////////////////////////////////////////////////////////////
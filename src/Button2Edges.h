@@ -0,0 +1,100 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Edges.h - Timestamped edge queue for Button2.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+
+  An interrupt (or a sampling backend) pushes every edge of the pin
+  together with the time it happened. loop() replays them in order
+  through Button2::feed(), so clicks are classified by the time of
+  the edges, not by the time the main loop gets around to them: a
+  flash write that blocks for a second no longer merges two clicks
+  into one or loses them.
+  Single producer, single consumer, no locks.
+  Not available with BUTTON2_TICK_MS: the tick clock stops while
+  loop() is blocked, the edges need a real clock.
+*/
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef Button2Edges_h
+#define Button2Edges_h
+
+/////////////////////////////////////////////////////////////////
+
+#include "Button2.h"
+
+#ifndef BUTTON2_TICK_MS
+
+/////////////////////////////////////////////////////////////////
+
+// must be a power of two, one slot is kept free
+#ifndef BUTTON2_EDGE_QUEUE_SIZE
+#define BUTTON2_EDGE_QUEUE_SIZE 16
+#endif
+
+#if (BUTTON2_EDGE_QUEUE_SIZE & (BUTTON2_EDGE_QUEUE_SIZE - 1)) != 0 || BUTTON2_EDGE_QUEUE_SIZE > 128
+#error "BUTTON2_EDGE_QUEUE_SIZE must be a power of two, at most 128"
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+struct Button2Edge {
+  unsigned long time;   // the button's clock, see Button2::getTime()
+  uint8_t level;        // raw pin level after the edge
+};
+
+/////////////////////////////////////////////////////////////////
+
+class Button2EdgeQueue {
+ protected:
+  Button2Edge edges[BUTTON2_EDGE_QUEUE_SIZE];
+  Button2* button = NULL;
+
+  uint8_t dropped = 0;    // written by the producer only, wraps
+  uint8_t head = 0;       // written by the producer only
+  uint8_t tail = 0;       // written by the consumer only
+  uint8_t resynced = 0;   // `dropped` at the last resync, consumer only
+
+ public:
+  void begin(Button2 &btn);
+
+  // Producer side, safe to call from an ISR. Defined here so it gets
+  // inlined into the ISR. `time` is a reading of the button's clock,
+  // taken by the caller: millis() (micros() with BUTTON2_USE_MICROS),
+  // or the function passed to setTimeFunction() if that is ISR safe.
+  // The queue doesn't read the clock itself, getTime() may call a
+  // std::function that isn't in IRAM on the ESPs.
+  bool push(uint8_t level, unsigned long time);
+
+  // Call instead of the button's loop()
+  void loop();
+  uint8_t available() const;
+  uint8_t getDroppedEdges() const;
+};
+
+/////////////////////////////////////////////////////////////////
+
+// Returns false and counts the edge as dropped if the queue is full,
+// loop() then reads the pin once the queue is drained. The count is
+// 8 bit, so the ISR stores it in one go on AVR too.
+inline bool Button2EdgeQueue::push(uint8_t level, unsigned long time) {
+  uint8_t h = head;
+  uint8_t next = (h + 1) & (BUTTON2_EDGE_QUEUE_SIZE - 1);
+  if (next == BUTTON2_LOAD(tail)) {
+    BUTTON2_STORE(dropped, (uint8_t)(dropped + 1));
+    return false;
+  }
+  edges[h].time = time;
+  edges[h].level = level;
+  // the edge must be visible before the new head
+  BUTTON2_FENCE_RELEASE();
+  BUTTON2_STORE(head, next);
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+#endif
+#endif
+/////////////////////////////////////////////////////////////////
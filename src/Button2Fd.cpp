@@ -0,0 +1,216 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Fd.cpp - File-descriptor input source for Button2 on Linux.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+*/
+/////////////////////////////////////////////////////////////////
+
+#include "Button2Fd.h"
+
+#ifdef BUTTON2_HAS_FD_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <unistd.h>
+#ifdef BUTTON2_FD_HAS_GPIO
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2FdSource::add(Button2 &btn, int fd, uint8_t initialLevel /* = HIGH */) {
+  return _add(btn, fd, level_bytes, initialLevel ? HIGH : LOW);
+}
+
+/////////////////////////////////////////////////////////////////
+
+#ifdef BUTTON2_FD_HAS_GPIO
+bool Button2FdSource::addGpioLine(Button2 &btn, int lineFd) {
+  struct gpio_v2_line_values values;
+  memset(&values, 0, sizeof(values));
+  values.mask = 1;
+  if (ioctl(lineFd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) < 0) return false;
+  return _add(btn, lineFd, gpio_line, (values.bits & 1) ? HIGH : LOW);
+}
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2FdSource::_add(Button2 &btn, int fd, uint8_t format, uint8_t level) {
+  if (fd < 0 || button_count >= BUTTON2_FD_MAX_BUTTONS) return false;
+
+  int flags = fcntl(fd, F_GETFL);
+  if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) return false;
+
+  uint8_t index = button_count++;
+  inputs[index].button = &btn;
+  inputs[index].time = btn.getTime();
+  inputs[index].fd = fd;
+  inputs[index].format = format;
+  inputs[index].level = level;
+
+  btn.setButtonStateFunction([this, index]() {
+    return inputs[index].level;
+  });
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint8_t Button2FdSource::getButtonCount() const {
+  return button_count;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Earliest deadline of all buttons, BTN_NO_DEADLINE if none.
+unsigned long Button2FdSource::timeToNextDeadline() const {
+  unsigned long next = BTN_NO_DEADLINE;
+  for (uint8_t i = 0; i < button_count; i++) {
+    unsigned long t = inputs[i].button->timeToNextDeadline();
+    if (t < next) next = t;
+  }
+  return next;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Blocks until an edge arrives, the next deadline of a button expires
+// or max_wait_ms has passed (-1 = no limit), then runs the buttons.
+// Returns the number of edges processed or -1 on a poll() error.
+int Button2FdSource::loop(int max_wait_ms /* = -1 */) {
+  int timeout = max_wait_ms;
+  unsigned long next = timeToNextDeadline();
+  if (next != BTN_NO_DEADLINE && (timeout < 0 || next < (unsigned long)timeout)) {
+    timeout = (next > INT_MAX) ? INT_MAX : (int)next;
+  }
+
+  struct pollfd fds[BUTTON2_FD_MAX_BUTTONS];
+  uint8_t polled[BUTTON2_FD_MAX_BUTTONS];
+  nfds_t n = 0;
+  for (uint8_t i = 0; i < button_count; i++) {
+    if (inputs[i].fd < 0) continue;
+    fds[n].fd = inputs[i].fd;
+    fds[n].events = POLLIN;
+    fds[n].revents = 0;
+    polled[n] = i;
+    n++;
+  }
+  // nothing could ever wake us up
+  if (n == 0 && timeout < 0) return 0;
+
+  int ready = poll(fds, n, timeout);
+  if (ready < 0 && errno != EINTR) return -1;
+  wakeup_count++;
+
+  int edges = 0;
+  for (nfds_t k = 0; ready > 0 && k < n; k++) {
+    if (fds[k].revents & (POLLIN | POLLHUP | POLLERR)) {
+      edges += _readInput(inputs[polled[k]]);
+    }
+  }
+  // handle expired deadlines
+  for (uint8_t i = 0; i < button_count; i++) {
+    inputs[i].button->loop();
+    inputs[i].time = inputs[i].button->getTime();
+  }
+  return edges;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Drains the fd, every level change runs the button once so that
+// bounces within a single read are seen by the debouncer.
+int Button2FdSource::_readInput(Input &in) {
+  int edges = 0;
+  while (true) {
+    ssize_t len;
+    if (in.format == level_bytes) {
+      uint8_t buf[64];
+      len = read(in.fd, buf, sizeof(buf));
+      for (ssize_t i = 0; i < len; i++) {
+        if (buf[i] == '0' || buf[i] == 0x00) edges += _setLevel(in, LOW);
+        if (buf[i] == '1' || buf[i] == 0x01) edges += _setLevel(in, HIGH);
+      }
+#ifdef BUTTON2_FD_HAS_GPIO
+    } else {
+      struct gpio_v2_line_event events[16];
+      len = read(in.fd, events, sizeof(events));
+      // the clocks are read once per batch, the edges are placed by
+      // their age relative to it
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      uint64_t now_ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+      unsigned long now = in.button->getTime();
+      for (ssize_t i = 0; i < len / (ssize_t)sizeof(events[0]); i++) {
+        edges += _feedEvent(in, events[i], now_ns, now);
+      }
+#else
+    } else {
+      len = -1;
+#endif
+    }
+    if (len > 0) continue;
+    // closed by the writer: stop polling, the fd is owned by the caller
+    if (len == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+      in.fd = -1;
+    }
+    return edges;
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+int Button2FdSource::_setLevel(Input &in, uint8_t level) {
+  if (in.level == level) return 0;
+  in.level = level;
+  edge_count++;
+  in.button->loop();
+  in.time = in.button->getTime();
+  return 1;
+}
+
+/////////////////////////////////////////////////////////////////
+
+#ifdef BUTTON2_FD_HAS_GPIO
+// Feeds an edge at the time the kernel saw it, converted to the
+// button's clock. Edges are never placed before the last processed
+// sample, i.e. an edge that was queued across a loop() counts from it.
+int Button2FdSource::_feedEvent(Input &in, const struct gpio_v2_line_event &event, uint64_t now_ns, unsigned long now) {
+  uint8_t level = (event.id == GPIO_V2_LINE_EVENT_RISING_EDGE) ? HIGH : LOW;
+  if (in.level == level) return 0;
+
+  uint64_t age_ns = (now_ns > event.timestamp_ns) ? now_ns - event.timestamp_ns : 0;
+  uint64_t age = age_ns / (1000000ULL / BUTTON2_TIME_PER_MS);
+  button2_time_t max_age = (button2_time_t)(now - in.time);
+  if (age > max_age) age = max_age;
+  unsigned long time = (button2_time_t)(now - (unsigned long)age);
+
+  in.level = level;
+  edge_count++;
+  in.button->feed(level, time);
+  in.time = time;
+  return 1;
+}
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+uint32_t Button2FdSource::getEdgeCount() const {
+  return edge_count;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint32_t Button2FdSource::getWakeupCount() const {
+  return wakeup_count;
+}
+
+/////////////////////////////////////////////////////////////////
+#endif
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,99 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Fd.h - File-descriptor input source for Button2 on Linux.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+
+  Feeds buttons from file descriptors (GPIO character-device line
+  requests, pipes, sockets) and sleeps in poll() until either an
+  edge arrives or the next timing deadline of a button expires,
+  instead of calling loop() every millisecond.
+*/
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef Button2Fd_h
+#define Button2Fd_h
+
+/////////////////////////////////////////////////////////////////
+
+#include "Button2.h"
+
+#ifndef BUTTON2_HAS_FD_SOURCE
+#if defined(BUTTON2_HAS_STD_FUNCTION) && defined(__linux__)
+#define BUTTON2_HAS_FD_SOURCE 1
+#endif
+#endif
+
+#ifdef BUTTON2_HAS_FD_SOURCE
+
+// GPIO character device (uAPI v2, Linux 5.10+)
+#if defined(__has_include)
+#if __has_include(<linux/gpio.h>)
+#include <linux/gpio.h>
+#ifdef GPIO_V2_LINE_GET_VALUES_IOCTL
+#define BUTTON2_FD_HAS_GPIO 1
+#endif
+#endif
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+#ifndef BUTTON2_FD_MAX_BUTTONS
+#define BUTTON2_FD_MAX_BUTTONS 16
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+class Button2FdSource {
+ protected:
+  enum inputFormat {
+    level_bytes,   // one byte per level: '0'/'1' or 0x00/0x01, others ignored
+    gpio_line      // struct gpio_v2_line_event records
+  };
+
+  struct Input {
+    Button2* button;
+    unsigned long time;   // button clock of the last sample processed
+    int fd;
+    uint8_t format;
+    uint8_t level;
+  };
+
+  Input inputs[BUTTON2_FD_MAX_BUTTONS];
+  uint32_t edge_count = 0;
+  uint32_t wakeup_count = 0;
+  uint8_t button_count = 0;
+
+  bool _add(Button2 &btn, int fd, uint8_t format, uint8_t level);
+  int _readInput(Input &in);
+  int _setLevel(Input &in, uint8_t level);
+#ifdef BUTTON2_FD_HAS_GPIO
+  int _feedEvent(Input &in, const struct gpio_v2_line_event &event, uint64_t now_ns, unsigned long now);
+#endif
+
+ public:
+  // Level-byte stream, e.g. a pipe or socket. The level is the raw
+  // pin level (HIGH/LOW), begin() decides whether it is active low.
+  // Call before begin(BTN_VIRTUAL_PIN, ...) of the button.
+  bool add(Button2 &btn, int fd, uint8_t initialLevel = HIGH);
+#ifdef BUTTON2_FD_HAS_GPIO
+  // Line request fd with edge detection on both edges (one line).
+  // The edges are processed with their kernel timestamps, taken on
+  // CLOCK_MONOTONIC (the default of the line request).
+  bool addGpioLine(Button2 &btn, int lineFd);
+#endif
+  uint8_t getButtonCount() const;
+
+  unsigned long timeToNextDeadline() const;
+  int loop(int max_wait_ms = -1);
+
+  uint32_t getEdgeCount() const;
+  uint32_t getWakeupCount() const;
+};
+
+/////////////////////////////////////////////////////////////////
+#endif
+#endif
+/////////////////////////////////////////////////////////////////
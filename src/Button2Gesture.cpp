@@ -0,0 +1,120 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Gesture.cpp - Press/release gestures for Button2.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+*/
+/////////////////////////////////////////////////////////////////
+
+#include "Button2Gesture.h"
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2GestureRecognizer::_attach(Button2 &btn, const uint8_t (*table_next)[BTN_GESTURE_SYMBOLS], const uint8_t* table_accept, GestureCallbackFunction f, bool flash) {
+  if (button != NULL) button->removeListener(*this);
+  button = &btn;
+  next = table_next;
+  accept = table_accept;
+  in_flash = flash;
+  gesture_cb = BUTTON2_MOVE(f);
+  state = 0;
+  pressed = false;
+  held = false;
+  pending = false;
+
+  btn.addListener(*this, link);
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint8_t Button2GestureRecognizer::_next(uint8_t from, uint8_t symbol) const {
+  return in_flash ? pgm_read_byte(&next[from][symbol]) : next[from][symbol];
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint8_t Button2GestureRecognizer::_accept(uint8_t at) const {
+  return in_flash ? pgm_read_byte(&accept[at]) : accept[at];
+}
+
+/////////////////////////////////////////////////////////////////
+
+// ms since a time of the button's clock
+unsigned long Button2GestureRecognizer::_since(unsigned long time) const {
+  return (button2_time_t)(button->getTime() - time) / BUTTON2_TIME_PER_MS;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Runs the button and the two timeouts of the recognizer:
+// a hold while pressed and the end of a sequence while released.
+void Button2GestureRecognizer::loop() {
+  if (button == NULL) return;
+  button->loop();
+
+  if (pressed && !held && _next(state, gesture_hold) != 0 && _since(press_ms) >= button->getLongClickTime()) {
+    held = true;
+    _step(gesture_hold);
+  }
+  // a press that is not debounced yet keeps the sequence open
+  if (pending && !button->isPressed() && _since(release_ms) > button->getDoubleClickTime()) {
+    pending = false;
+    _finish();
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint8_t Button2GestureRecognizer::getState() const {
+  return state;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Only the debounced press and release edges are used, timed by the
+// edges behind them.
+void Button2GestureRecognizer::onButtonEvent(Button2 &btn, buttonEvent ev) {
+  if (&btn != button) return;
+
+  if (ev == pressed_event) {
+    // the press is reported once it is debounced
+    press_ms = btn.getEdgeTime();
+    pressed = true;
+    held = false;
+    pending = false;
+
+  } else if (ev == released_event) {
+    pressed = false;
+    // the hold already completed (and reset) the gesture
+    if (held) return;
+    _step(btn.wasPressedFor() >= btn.getLongClickTime() ? gesture_long : gesture_short);
+    release_ms = btn.getEdgeTime();
+    pending = (state != 0);
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2GestureRecognizer::_step(uint8_t symbol) {
+  state = _next(state, symbol);
+  if (state == 0) return;
+
+  // no longer gesture possible: report without waiting
+  if (_next(state, gesture_short) == 0 && _next(state, gesture_long) == 0 && _next(state, gesture_hold) == 0) {
+    pending = false;
+    _finish();
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2GestureRecognizer::_finish() {
+  uint8_t gesture = _accept(state);
+  state = 0;
+  if (gesture != BTN_GESTURE_NONE && gesture_cb != BUTTON2_NULL) {
+    gesture_cb(*button, gesture);
+  }
+}
+
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,157 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Gesture.h - Press/release gestures for Button2.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+
+  Gestures are strings over three symbols:
+    '.'  short press (released before the long click time)
+    '-'  long press (released after the long click time)
+    '_'  hold (still pressed after the long click time), must be last
+  e.g. "._" = click then hold, "-.-" = long-short-long, "...---...".
+
+  The patterns are compiled into a DFA transition table (a trie),
+  at compile time with C++14 or newer. Matching costs O(1) per edge,
+  no matter how many gestures are registered.
+*/
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef Button2Gesture_h
+#define Button2Gesture_h
+
+/////////////////////////////////////////////////////////////////
+
+#include "Button2.h"
+#include <stddef.h>
+
+// Tables are built at compile time where the compiler allows it:
+// static BUTTON2_GESTURE_CONSTEXPR Button2GestureTable<16> table(patterns);
+#if __cplusplus >= 201402L
+  #define BUTTON2_GESTURE_CONSTEXPR14 constexpr
+  #define BUTTON2_GESTURE_CONSTEXPR constexpr
+#else
+  #define BUTTON2_GESTURE_CONSTEXPR14
+  #define BUTTON2_GESTURE_CONSTEXPR const
+#endif
+
+// Tables in flash are read through pgm_read_byte(), see begin_P()
+#ifndef PROGMEM
+  #define PROGMEM
+#endif
+#ifndef pgm_read_byte
+  #define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+enum gestureSymbol {
+  gesture_short,
+  gesture_long,
+  gesture_hold
+};
+
+const uint8_t BTN_GESTURE_SYMBOLS = 3;
+const uint8_t BTN_GESTURE_NONE = 0xFF;
+
+/////////////////////////////////////////////////////////////////
+// DFA transition table, state 0 is the start state.
+// A transition to 0 means no gesture continues with this symbol.
+
+template <uint8_t MAX_STATES>
+struct Button2GestureTable {
+  uint8_t next[MAX_STATES][BTN_GESTURE_SYMBOLS];
+  uint8_t accept[MAX_STATES];  // index of the matching pattern or BTN_GESTURE_NONE
+  uint8_t states;
+  bool valid;                  // false: unknown symbol, '_' not last or too many states
+
+  template <size_t N>
+  BUTTON2_GESTURE_CONSTEXPR14 explicit Button2GestureTable(const char* const (&patterns)[N])
+    : next(), accept(), states(1), valid(N < BTN_GESTURE_NONE) {
+    for (uint8_t s = 0; s < MAX_STATES; s++) accept[s] = BTN_GESTURE_NONE;
+
+    for (size_t p = 0; p < N && valid; p++) {
+      uint8_t s = 0;
+      for (const char* c = patterns[p]; *c != '\0' && valid; c++) {
+        uint8_t sym = BTN_GESTURE_SYMBOLS;
+        if (*c == '.') sym = gesture_short;
+        if (*c == '-') sym = gesture_long;
+        if (*c == '_') sym = gesture_hold;
+        if (sym == BTN_GESTURE_SYMBOLS || (sym == gesture_hold && c[1] != '\0')) {
+          valid = false;
+        } else if (next[s][sym] != 0) {
+          s = next[s][sym];
+        } else if (states < MAX_STATES) {
+          next[s][sym] = states;
+          s = states++;
+        } else {
+          valid = false;
+        }
+      }
+      // the empty pattern never matches
+      if (valid && s != 0) accept[s] = (uint8_t)p;
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////
+// Feeds the debounced edges of one button into a gesture table
+
+class Button2GestureRecognizer : public Button2Listener {
+ protected:
+#ifdef BUTTON2_HAS_STD_FUNCTION
+  typedef std::function<void(Button2 &btn, uint8_t gesture)> GestureCallbackFunction;
+#else
+  typedef void (*GestureCallbackFunction)(Button2 &, uint8_t);
+#endif
+
+  GestureCallbackFunction gesture_cb = BUTTON2_NULL;
+  const uint8_t (*next)[BTN_GESTURE_SYMBOLS] = NULL;
+  const uint8_t* accept = NULL;
+  Button2* button = NULL;
+  Button2ListenerLink link;
+
+  unsigned long press_ms = 0;
+  unsigned long release_ms = 0;
+
+  uint8_t state = 0;
+  bool pressed = false;
+  bool held = false;
+  bool pending = false;
+  bool in_flash = false;
+
+  void onButtonEvent(Button2 &btn, buttonEvent ev) override;
+  uint8_t _next(uint8_t from, uint8_t symbol) const;
+  uint8_t _accept(uint8_t at) const;
+  unsigned long _since(unsigned long time) const;
+  void _step(uint8_t symbol);
+  void _finish();
+  bool _attach(Button2 &btn, const uint8_t (*table_next)[BTN_GESTURE_SYMBOLS], const uint8_t* table_accept, GestureCallbackFunction f, bool flash);
+
+ public:
+  // The recognizer listens to the button's events, its handlers and
+  // context stay free.
+  template <uint8_t MAX_STATES>
+  bool begin(Button2 &btn, const Button2GestureTable<MAX_STATES> &table, GestureCallbackFunction f) {
+    if (!table.valid) return false;
+    return _attach(btn, table.next, table.accept, BUTTON2_MOVE(f), false);
+  }
+
+  // Same for a table in flash, e.g. on AVR (needs C++14, so that the
+  // compiler builds the table):
+  // static constexpr Button2GestureTable<16> table PROGMEM(patterns);
+  template <uint8_t MAX_STATES>
+  bool begin_P(Button2 &btn, const Button2GestureTable<MAX_STATES> &table, GestureCallbackFunction f) {
+    if (!pgm_read_byte(&table.valid)) return false;
+    return _attach(btn, table.next, table.accept, BUTTON2_MOVE(f), true);
+  }
+
+  // Call instead of the button's loop()
+  void loop();
+  uint8_t getState() const;
+};
+
+/////////////////////////////////////////////////////////////////
+#endif
+/////////////////////////////////////////////////////////////////
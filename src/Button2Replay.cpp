@@ -0,0 +1,182 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Replay.cpp - Deterministic replay of recorded input for Button2.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+*/
+/////////////////////////////////////////////////////////////////
+
+#include "Button2Replay.h"
+
+#ifndef BUTTON2_TICK_MS
+
+/////////////////////////////////////////////////////////////////
+// the virtual clock
+
+static unsigned long replay_clock = 0;
+
+static unsigned long _replayClock() {
+  return replay_clock;
+}
+
+/////////////////////////////////////////////////////////////////
+
+Button2Replay::~Button2Replay() {
+  end();
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2Replay::begin(Button2 &btn, unsigned long start /* = 0 */) {
+  if (button == NULL) {
+    prev_clock = Button2::getTimeFunction();
+  } else {
+    button->removeListener(*this);
+  }
+  button = &btn;
+  replay_clock = start;
+  samples = 0;
+  for (uint8_t i = 0; i < BTN_EVENT_COUNT; i++) events[i] = 0;
+  Button2::setTimeFunction(_replayClock);
+  btn.addListener(*this, link);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2Replay::end() {
+  if (button == NULL) return;
+  button->removeListener(*this);
+  Button2::setTimeFunction(BUTTON2_MOVE(prev_clock));
+  prev_clock = BUTTON2_NULL;
+  button = NULL;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2Replay::onButtonEvent(Button2 &btn, buttonEvent ev) {
+  if (&btn != button) return;
+  if (ev < BTN_EVENT_COUNT) events[ev]++;
+  if (output != NULL) {
+    output->print(replay_clock);
+    output->print(',');
+    output->println(eventToString(ev));
+  }
+  if (event_cb != BUTTON2_NULL) event_cb(*button, ev, replay_clock);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2Replay::setEventHandler(ReplayCallbackFunction f) {
+  event_cb = BUTTON2_MOVE(f);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2Replay::setOutput(Print &out) {
+  output = &out;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Moves the clock from one timing decision to the next up to `time`,
+// so the events happen at the times a loop() without delay would see
+void Button2Replay::_runTo(unsigned long time) {
+  while ((long)(time - replay_clock) > 0) {
+    unsigned long wait = button->timeToNextDeadline(replay_clock);
+    if (wait == BTN_NO_DEADLINE || wait >= time - replay_clock) break;
+    // a decision that is due now was made by the last step
+    replay_clock += (wait > 0) ? wait : 1;
+    button->advanceTo(replay_clock);
+  }
+  replay_clock = time;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Processes the level sampled at `time`. Times before the clock are
+// taken as now.
+void Button2Replay::sample(uint8_t level, unsigned long time) {
+  if (button == NULL) return;
+  _runTo(time);
+  button->feed(level, replay_clock);
+  samples++;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Lets the time pass without a new sample
+void Button2Replay::advanceTo(unsigned long time) {
+  if (button == NULL) return;
+  _runTo(time);
+  button->advanceTo(replay_clock);
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Runs the pending decisions, e.g. reports a click that still waits
+// for the double click time. A held button stays pressed.
+void Button2Replay::finish() {
+  if (button == NULL) return;
+  unsigned long wait = button->timeToNextDeadline(replay_clock);
+  for (uint8_t i = 0; i < BTN_CATCHUP_STEPS && wait != BTN_NO_DEADLINE; i++) {
+    advanceTo(replay_clock + ((wait > 0) ? wait : 1));
+    wait = button->timeToNextDeadline(replay_clock);
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Replays the records of a trace that were recorded from the button
+// with the ID `source_id`, then finishes. Returns the number of
+// records replayed.
+uint32_t Button2Replay::replay(Button2TraceReader &reader, uint16_t source_id) {
+  if (button == NULL) return 0;
+  uint32_t count = 0;
+  Button2TraceRecord rec;
+  while (reader.next(rec)) {
+    if (rec.id != source_id) continue;
+    sample(rec.level, rec.time);
+    count++;
+  }
+  finish();
+  return count;
+}
+
+/////////////////////////////////////////////////////////////////
+
+unsigned long Button2Replay::getTime() const {
+  return replay_clock;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint32_t Button2Replay::getSamples() const {
+  return samples;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint32_t Button2Replay::getEventCount(buttonEvent ev) const {
+  return (ev < BTN_EVENT_COUNT) ? events[ev] : 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+const char* Button2Replay::eventToString(buttonEvent ev) {
+  switch (ev) {
+    case pressed_event: return "pressed";
+    case released_event: return "released";
+    case changed_event: return "changed";
+    case tap_event: return "tap";
+    case click_event: return "click";
+    case double_click_event: return "double_click";
+    case triple_click_event: return "triple_click";
+    case long_click_event: return "long_click";
+    case longclick_detected_event: return "longclick_detected";
+  }
+  return "unknown";
+}
+
+/////////////////////////////////////////////////////////////////
+#endif
+/////////////////////////////////////////////////////////////////
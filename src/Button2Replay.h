@@ -0,0 +1,83 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Replay.h - Deterministic replay of recorded input for Button2.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+
+  Runs a trace of (time, level) samples through a button on a virtual
+  clock and reports the resulting events with their times. The clock
+  jumps from one sample or timing decision to the next, so hours of
+  recorded activity replay in milliseconds, with the same result on
+  every run: to reproduce a bug from the field (see Button2Trace.h) or
+  to check what a change of the timeouts does to a recorded session.
+  The virtual clock replaces the clock of all buttons while the replay
+  runs (Button2::setTimeFunction()), one replay at a time. The events
+  are taken as a listener, the button's handlers stay free.
+  Not available with BUTTON2_TICK_MS, the tick clock can't be set.
+*/
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef Button2Replay_h
+#define Button2Replay_h
+
+/////////////////////////////////////////////////////////////////
+
+#include "Button2.h"
+#include "Button2Trace.h"
+
+#ifndef BUTTON2_TICK_MS
+
+/////////////////////////////////////////////////////////////////
+
+class Button2Replay : public Button2Listener {
+ protected:
+#ifdef BUTTON2_HAS_STD_FUNCTION
+  typedef std::function<void(Button2 &btn, buttonEvent ev, unsigned long time)> ReplayCallbackFunction;
+  typedef std::function<unsigned long()> TimeCallbackFunction;
+#else
+  typedef void (*ReplayCallbackFunction)(Button2 &, buttonEvent, unsigned long);
+  typedef unsigned long (*TimeCallbackFunction)();
+#endif
+
+  ReplayCallbackFunction event_cb = BUTTON2_NULL;
+  TimeCallbackFunction prev_clock = BUTTON2_NULL;
+  Button2* button = NULL;
+  Button2ListenerLink link;
+  Print* output = NULL;
+  uint32_t events[BTN_EVENT_COUNT] = {};
+  uint32_t samples = 0;
+
+  void onButtonEvent(Button2 &btn, buttonEvent ev) override;
+  void _runTo(unsigned long time);
+
+ public:
+  ~Button2Replay();
+
+  // Installs the virtual clock, set to `start`. Call it before the
+  // button's begin(), so all its timestamps come from that clock.
+  void begin(Button2 &btn, unsigned long start = 0);
+  // Puts the clock back that was set before begin()
+  void end();
+
+  void setEventHandler(ReplayCallbackFunction f);
+  // Prints every event as a CSV line: time,event
+  void setOutput(Print &out);
+
+  // Samples in time order, in the button's clock units
+  void sample(uint8_t level, unsigned long time);
+  void advanceTo(unsigned long time);
+  void finish();
+  uint32_t replay(Button2TraceReader &reader, uint16_t source_id);
+
+  unsigned long getTime() const;
+  uint32_t getSamples() const;
+  uint32_t getEventCount(buttonEvent ev) const;
+  static const char* eventToString(buttonEvent ev);
+};
+
+/////////////////////////////////////////////////////////////////
+#endif
+#endif
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,283 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Scanner.cpp - Background scanning task for Button2.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+*/
+/////////////////////////////////////////////////////////////////
+
+#include "Button2Scanner.h"
+
+#ifdef BUTTON2_HAS_SCANNER
+
+/////////////////////////////////////////////////////////////////
+// FreeRTOS backend
+
+#if defined(ESP32)
+
+Button2FreeRTOSBackend::~Button2FreeRTOSBackend() {
+  if (event_sem != NULL) vSemaphoreDelete(event_sem);
+  if (done_sem != NULL) vSemaphoreDelete(done_sem);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2FreeRTOSBackend::_entry(void* self) {
+  Button2FreeRTOSBackend* b = (Button2FreeRTOSBackend*)self;
+  b->task_fn(b->task_arg);
+  xSemaphoreGive(b->done_sem);
+  vTaskDelete(NULL);
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2FreeRTOSBackend::start(TaskFunction fn, void* arg, uint8_t priority, uint32_t stackSize) {
+  if (task != NULL) return false;
+  if (event_sem == NULL) event_sem = xSemaphoreCreateBinary();
+  if (done_sem == NULL) done_sem = xSemaphoreCreateBinary();
+  if (event_sem == NULL || done_sem == NULL) return false;
+
+  task_fn = fn;
+  task_arg = arg;
+  last_wake = 0;
+  return xTaskCreate(_entry, "Button2Scan", stackSize, this, priority, &task) == pdPASS;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2FreeRTOSBackend::join() {
+  if (task == NULL) return;
+  xSemaphoreTake(done_sem, portMAX_DELAY);
+  task = NULL;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2FreeRTOSBackend::waitForNextPeriod(unsigned long period_ms) {
+  TickType_t ticks = pdMS_TO_TICKS(period_ms);
+  if (ticks == 0) ticks = 1;
+  if (last_wake == 0) last_wake = xTaskGetTickCount();
+  vTaskDelayUntil(&last_wake, ticks);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2FreeRTOSBackend::signal() {
+  xSemaphoreGive(event_sem);
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2FreeRTOSBackend::waitForSignal(unsigned long timeout_ms) {
+  return xSemaphoreTake(event_sem, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
+
+/////////////////////////////////////////////////////////////////
+// std::thread backend
+
+#else
+
+Button2StdThreadBackend::~Button2StdThreadBackend() {
+  join();
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2StdThreadBackend::start(TaskFunction fn, void* arg, uint8_t /* priority */, uint32_t /* stackSize */) {
+  if (thread.joinable()) return false;
+  first_period = true;
+  thread = std::thread(fn, arg);
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2StdThreadBackend::join() {
+  if (thread.joinable()) thread.join();
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2StdThreadBackend::waitForNextPeriod(unsigned long period_ms) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::chrono::milliseconds period(period_ms);
+  // (re)start the schedule on the first period or after a stall,
+  // instead of running a burst of scans to catch up
+  if (first_period || now > next_wake + period) {
+    next_wake = now;
+    first_period = false;
+  }
+  next_wake += period;
+  std::this_thread::sleep_until(next_wake);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2StdThreadBackend::signal() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    signaled = true;
+  }
+  cond.notify_one();
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2StdThreadBackend::waitForSignal(unsigned long timeout_ms) {
+  std::unique_lock<std::mutex> lock(mutex);
+  cond.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] { return signaled; });
+  bool res = signaled;
+  signaled = false;
+  return res;
+}
+
+#endif
+
+/////////////////////////////////////////////////////////////////
+// Scanner
+
+Button2Scanner::Button2Scanner() : Button2Scanner(default_backend) {
+}
+
+/////////////////////////////////////////////////////////////////
+
+Button2Scanner::Button2Scanner(Button2TaskBackend &taskBackend)
+    : backend(&taskBackend), head(0), tail(0), dropped(0), scans(0), running(false) {
+}
+
+/////////////////////////////////////////////////////////////////
+
+Button2Scanner::~Button2Scanner() {
+  end();
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Buttons can only be added while the task is stopped, each one once.
+// The scanner listens to the button's events, its handlers stay free.
+bool Button2Scanner::add(Button2 &btn) {
+  if (running) return false;
+  if (button_count >= BUTTON2_SCANNER_MAX_BUTTONS) return false;
+  if (!btn.addListener(*this, links[button_count])) return false;
+
+  buttons[button_count++] = &btn;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint8_t Button2Scanner::getButtonCount() const {
+  return button_count;
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2Scanner::begin(unsigned long scan_interval_ms /* = BTN_SCAN_INTERVAL_MS */, uint8_t priority /* = 5 */, uint32_t stackSize /* = 4096 */) {
+  if (running) return false;
+  interval_ms = scan_interval_ms;
+  running = true;
+  if (!backend->start(_task, this, priority, stackSize)) {
+    running = false;
+    return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2Scanner::end() {
+  if (!running) return;
+  running = false;
+  backend->join();
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2Scanner::isRunning() const {
+  return running;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2Scanner::_task(void* self) {
+  Button2Scanner* scanner = (Button2Scanner*)self;
+  while (scanner->running) {
+    scanner->_scan();
+    scanner->backend->waitForNextPeriod(scanner->interval_ms);
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2Scanner::_scan() {
+  for (uint8_t i = 0; i < button_count; i++) {
+    buttons[i]->loop();
+  }
+  scans.fetch_add(1, std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Called for the events of the scanned buttons.
+void Button2Scanner::onButtonEvent(Button2 &btn, buttonEvent ev) {
+  _push(btn, ev);
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Called on the scan task. If the queue is full the event is dropped
+// and counted, the scan task never blocks on a slow consumer.
+void Button2Scanner::_push(Button2 &btn, buttonEvent ev) {
+  uint16_t h = head.load(std::memory_order_relaxed);
+  uint16_t t = tail.load(std::memory_order_acquire);
+  if ((uint16_t)(h - t) >= BUTTON2_SCANNER_QUEUE_SIZE) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  Button2Event &e = queue[h & (BUTTON2_SCANNER_QUEUE_SIZE - 1)];
+  e.button = &btn;
+  e.type = ev;
+  e.time = btn.getEventTime();
+  head.store(h + 1, std::memory_order_release);
+  backend->signal();
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Fetch the next event, waiting up to `timeout_ms` for one to arrive.
+bool Button2Scanner::nextEvent(Button2Event &ev, unsigned long timeout_ms /* = 0 */) {
+  unsigned long start = millis();
+  while (true) {
+    uint16_t t = tail.load(std::memory_order_relaxed);
+    if (t != head.load(std::memory_order_acquire)) {
+      ev = queue[t & (BUTTON2_SCANNER_QUEUE_SIZE - 1)];
+      tail.store(t + 1, std::memory_order_release);
+      return true;
+    }
+    unsigned long elapsed = millis() - start;
+    if (elapsed >= timeout_ms) return false;
+    backend->waitForSignal(timeout_ms - elapsed);
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint8_t Button2Scanner::available() const {
+  return (uint16_t)(head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed));
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint32_t Button2Scanner::getDroppedEvents() const {
+  return dropped.load(std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint32_t Button2Scanner::getScanCount() const {
+  return scans.load(std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////////////////////
+#endif
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,187 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Scanner.h - Background scanning task for Button2.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+
+  Runs the loop() of a set of buttons from a dedicated task at a fixed
+  rate and hands the resulting events to the application through a queue.
+  The thread backend is pluggable: FreeRTOS on ESP32, std::thread on
+  native (EpoxyDuino / Linux) builds. Other RTOSes can be supported by
+  implementing Button2TaskBackend and defining BUTTON2_HAS_SCANNER.
+*/
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef Button2Scanner_h
+#define Button2Scanner_h
+
+/////////////////////////////////////////////////////////////////
+
+#include "Button2.h"
+
+#ifndef BUTTON2_HAS_SCANNER
+#if defined(BUTTON2_HAS_STD_FUNCTION) && (defined(ESP32) || defined(EPOXY_DUINO) || (!defined(ARDUINO) && defined(__linux__)))
+#define BUTTON2_HAS_SCANNER 1
+#endif
+#endif
+
+#ifdef BUTTON2_HAS_SCANNER
+
+#include <atomic>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#else
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+#ifndef BUTTON2_SCANNER_MAX_BUTTONS
+#define BUTTON2_SCANNER_MAX_BUTTONS 16
+#endif
+
+// must be a power of two
+#ifndef BUTTON2_SCANNER_QUEUE_SIZE
+#define BUTTON2_SCANNER_QUEUE_SIZE 32
+#endif
+
+const unsigned int BTN_SCAN_INTERVAL_MS = 5;
+
+/////////////////////////////////////////////////////////////////
+
+struct Button2Event {
+  Button2* button;
+  buttonEvent type;
+  unsigned long time;
+};
+
+/////////////////////////////////////////////////////////////////
+// Thread backend interface
+
+class Button2TaskBackend {
+ public:
+  typedef void (*TaskFunction)(void* arg);
+
+  virtual ~Button2TaskBackend() {}
+
+  // start `fn(arg)` in a new task/thread
+  virtual bool start(TaskFunction fn, void* arg, uint8_t priority, uint32_t stackSize) = 0;
+  // wait until the task function has returned
+  virtual void join() = 0;
+  // called from the task: sleep until the next period starts
+  virtual void waitForNextPeriod(unsigned long period_ms) = 0;
+  // wake up a consumer blocked in waitForSignal()
+  virtual void signal() = 0;
+  // block the consumer until signal() or timeout, returns false on timeout
+  virtual bool waitForSignal(unsigned long timeout_ms) = 0;
+};
+
+/////////////////////////////////////////////////////////////////
+
+#if defined(ESP32)
+
+class Button2FreeRTOSBackend : public Button2TaskBackend {
+ protected:
+  TaskHandle_t task = NULL;
+  SemaphoreHandle_t event_sem = NULL;
+  SemaphoreHandle_t done_sem = NULL;
+  TickType_t last_wake = 0;
+  TaskFunction task_fn = NULL;
+  void* task_arg = NULL;
+
+  static void _entry(void* self);
+
+ public:
+  ~Button2FreeRTOSBackend();
+
+  bool start(TaskFunction fn, void* arg, uint8_t priority, uint32_t stackSize) override;
+  void join() override;
+  void waitForNextPeriod(unsigned long period_ms) override;
+  void signal() override;
+  bool waitForSignal(unsigned long timeout_ms) override;
+};
+
+typedef Button2FreeRTOSBackend Button2DefaultBackend;
+
+#else
+
+class Button2StdThreadBackend : public Button2TaskBackend {
+ protected:
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable cond;
+  bool signaled = false;
+  std::chrono::steady_clock::time_point next_wake;
+  bool first_period = true;
+
+ public:
+  ~Button2StdThreadBackend();
+
+  // std::thread has no portable priority or stack size, both are ignored
+  bool start(TaskFunction fn, void* arg, uint8_t priority, uint32_t stackSize) override;
+  void join() override;
+  void waitForNextPeriod(unsigned long period_ms) override;
+  void signal() override;
+  bool waitForSignal(unsigned long timeout_ms) override;
+};
+
+typedef Button2StdThreadBackend Button2DefaultBackend;
+
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+class Button2Scanner : public Button2Listener {
+ protected:
+  Button2DefaultBackend default_backend;
+  Button2TaskBackend* backend;
+
+  Button2* buttons[BUTTON2_SCANNER_MAX_BUTTONS];
+  Button2ListenerLink links[BUTTON2_SCANNER_MAX_BUTTONS];
+  Button2Event queue[BUTTON2_SCANNER_QUEUE_SIZE];
+
+  // single producer (scan task) / single consumer (application)
+  std::atomic<uint16_t> head;
+  std::atomic<uint16_t> tail;
+  std::atomic<uint32_t> dropped;
+  std::atomic<uint32_t> scans;
+  std::atomic<bool> running;
+
+  unsigned long interval_ms = BTN_SCAN_INTERVAL_MS;
+  uint8_t button_count = 0;
+
+  void onButtonEvent(Button2 &btn, buttonEvent ev) override;
+  void _push(Button2 &btn, buttonEvent ev);
+  void _scan();
+  static void _task(void* self);
+
+ public:
+  Button2Scanner();
+  explicit Button2Scanner(Button2TaskBackend &taskBackend);
+  ~Button2Scanner();
+
+  bool add(Button2 &btn);
+  uint8_t getButtonCount() const;
+
+  bool begin(unsigned long scan_interval_ms = BTN_SCAN_INTERVAL_MS, uint8_t priority = 5, uint32_t stackSize = 4096);
+  void end();
+  bool isRunning() const;
+
+  bool nextEvent(Button2Event &ev, unsigned long timeout_ms = 0);
+  uint8_t available() const;
+  uint32_t getDroppedEvents() const;
+  uint32_t getScanCount() const;
+};
+
+/////////////////////////////////////////////////////////////////
+#endif
+#endif
+/////////////////////////////////////////////////////////////////
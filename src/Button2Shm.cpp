@@ -0,0 +1,305 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Shm.cpp - Shared-memory state export for Button2 on Linux.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+*/
+/////////////////////////////////////////////////////////////////
+
+#include "Button2Shm.h"
+
+#ifdef BUTTON2_HAS_SHM
+
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/////////////////////////////////////////////////////////////////
+// Publisher
+
+Button2ShmPublisher::~Button2ShmPublisher() {
+  end();
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Creates the segment, e.g. begin("/button2"). Fails if it exists,
+// i.e. another publisher owns it or one crashed without end(), see
+// removeSegment(), or if the name is longer than BUTTON2_SHM_MAX_NAME - 1.
+bool Button2ShmPublisher::begin(const char* segmentName) {
+  if (shm != NULL) return false;
+  if (strlen(segmentName) >= sizeof(name)) return false;
+
+  int fd = shm_open(segmentName, O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) return false;
+  void* mem = MAP_FAILED;
+  if (ftruncate(fd, sizeof(Button2ShmSegment)) == 0) {
+    mem = mmap(NULL, sizeof(Button2ShmSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (mem == MAP_FAILED) {
+    shm_unlink(segmentName);
+    return false;
+  }
+
+  strcpy(name, segmentName);
+  shm = (Button2ShmSegment*)mem;
+  memset(shm, 0, sizeof(Button2ShmSegment));
+  shm->version = BUTTON2_SHM_VERSION;
+  shm->ring_size = BUTTON2_SHM_RING_SIZE;
+  button_count = 0;
+  // readers check the magic last
+  __atomic_store_n(&shm->magic, (uint32_t)BUTTON2_SHM_MAGIC, __ATOMIC_RELEASE);
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2ShmPublisher::end() {
+  if (shm == NULL) return;
+  for (uint8_t i = 0; i < button_count; i++) buttons[i]->removeListener(*this);
+  munmap(shm, sizeof(Button2ShmSegment));
+  shm_unlink(name);
+  shm = NULL;
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2ShmPublisher::isOpen() const {
+  return shm != NULL;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Removes a segment left behind by a publisher that did not end().
+// Readers that have it mapped keep their copy.
+bool Button2ShmPublisher::removeSegment(const char* segmentName) {
+  return shm_unlink(segmentName) == 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2ShmPublisher::add(Button2 &btn) {
+  if (shm == NULL) return false;
+  if (button_count >= BUTTON2_SHM_MAX_BUTTONS) return false;
+  if (!btn.addListener(*this, links[button_count])) return false;
+
+  uint8_t index = button_count++;
+  buttons[index] = &btn;
+  shm->button_ids[index] = btn.getID();
+
+  // a button held while it is added has no pressed event to come
+  uint32_t seq = shm->seq;
+  __atomic_store_n(&shm->seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  uint64_t pressed = shm->pressed & ~((uint64_t)1 << index);
+  if (btn.isPressed()) pressed |= ((uint64_t)1 << index);
+  __atomic_store_n(&shm->pressed, pressed, __ATOMIC_RELAXED);
+  __atomic_store_n(&shm->seq, seq + 2, __ATOMIC_RELEASE);
+
+  __atomic_store_n(&shm->button_count, (uint16_t)button_count, __ATOMIC_RELEASE);
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint8_t Button2ShmPublisher::getButtonCount() const {
+  return button_count;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2ShmPublisher::onButtonEvent(Button2 &btn, buttonEvent ev) {
+  for (uint8_t i = 0; i < button_count; i++) {
+    if (buttons[i] == &btn) {
+      _onEvent(i, btn, ev);
+      return;
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Runs on the thread calling loop(), the only writer of the segment.
+void Button2ShmPublisher::_onEvent(uint8_t index, Button2 &btn, buttonEvent ev) {
+  if (shm == NULL) return;
+
+  bool is_click = (ev == click_event || ev == double_click_event || ev == triple_click_event || ev == long_click_event);
+  uint8_t clicks = is_click ? btn.getNumberOfClicks() : 0;
+
+  // state: pressed bitmap + counters under the seqlock
+  uint32_t seq = shm->seq;
+  __atomic_store_n(&shm->seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  uint64_t pressed = shm->pressed;
+  if (ev == pressed_event) pressed |= ((uint64_t)1 << index);
+  if (ev == released_event) pressed &= ~((uint64_t)1 << index);
+  __atomic_store_n(&shm->pressed, pressed, __ATOMIC_RELAXED);
+
+  Button2ShmCounters &c = shm->counters[index];
+  __atomic_store_n(&c.events[ev], c.events[ev] + 1, __ATOMIC_RELAXED);
+  if (is_click) __atomic_store_n(&c.last_clicks, (uint32_t)clicks, __ATOMIC_RELAXED);
+
+  __atomic_store_n(&shm->seq, seq + 2, __ATOMIC_RELEASE);
+
+  // event ring: each slot carries its own sequence number
+  uint32_t head = shm->event_head;
+  Button2ShmEvent &slot = shm->ring[head & (BUTTON2_SHM_RING_SIZE - 1)];
+  __atomic_store_n(&slot.seq, (uint32_t)0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  __atomic_store_n(&slot.time_ms, (uint32_t)(btn.getEventTime() / BUTTON2_TIME_PER_MS), __ATOMIC_RELAXED);
+  __atomic_store_n(&slot.button, (uint16_t)index, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot.type, (uint8_t)ev, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot.clicks, clicks, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot.seq, head + 1, __ATOMIC_RELEASE);
+  __atomic_store_n(&shm->event_head, head + 1, __ATOMIC_RELEASE);
+}
+
+/////////////////////////////////////////////////////////////////
+// Reader
+
+Button2ShmReader::~Button2ShmReader() {
+  end();
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2ShmReader::begin(const char* segmentName) {
+  if (shm != NULL) return false;
+
+  int fd = shm_open(segmentName, O_RDONLY, 0);
+  if (fd < 0) return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Button2ShmSegment)) {
+    close(fd);
+    return false;
+  }
+  void* mem = mmap(NULL, sizeof(Button2ShmSegment), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED) return false;
+
+  const Button2ShmSegment* seg = (const Button2ShmSegment*)mem;
+  if (__atomic_load_n(&seg->magic, __ATOMIC_ACQUIRE) != BUTTON2_SHM_MAGIC ||
+      seg->version != BUTTON2_SHM_VERSION || seg->ring_size != BUTTON2_SHM_RING_SIZE) {
+    munmap(mem, sizeof(Button2ShmSegment));
+    return false;
+  }
+  shm = seg;
+  // only report events from now on
+  cursor = __atomic_load_n(&shm->event_head, __ATOMIC_ACQUIRE);
+  lost = 0;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2ShmReader::end() {
+  if (shm == NULL) return;
+  munmap((void*)shm, sizeof(Button2ShmSegment));
+  shm = NULL;
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2ShmReader::isOpen() const {
+  return shm != NULL;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint16_t Button2ShmReader::getButtonCount() const {
+  if (shm == NULL) return 0;
+  return __atomic_load_n(&shm->button_count, __ATOMIC_ACQUIRE);
+}
+
+/////////////////////////////////////////////////////////////////
+
+int Button2ShmReader::getButtonID(uint16_t index) const {
+  if (index >= getButtonCount()) return -1;
+  return shm->button_ids[index];
+}
+
+/////////////////////////////////////////////////////////////////
+
+// A single 64-bit load, no seqlock needed
+uint64_t Button2ShmReader::getPressed() const {
+  if (shm == NULL) return 0;
+  return __atomic_load_n(&shm->pressed, __ATOMIC_ACQUIRE);
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2ShmReader::isPressed(uint16_t index) const {
+  if (index >= BUTTON2_SHM_MAX_BUTTONS) return false;
+  return (getPressed() >> index) & 1;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Consistent copy of the bitmap and all counters
+void Button2ShmReader::read(Button2ShmState &state) const {
+  memset(&state, 0, sizeof(state));
+  if (shm == NULL) return;
+
+  uint32_t seq1, seq2;
+  do {
+    seq1 = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE);
+    state.button_count = __atomic_load_n(&shm->button_count, __ATOMIC_RELAXED);
+    state.pressed = __atomic_load_n(&shm->pressed, __ATOMIC_RELAXED);
+    for (uint16_t i = 0; i < state.button_count && i < BUTTON2_SHM_MAX_BUTTONS; i++) {
+      for (uint8_t e = 0; e < BTN_EVENT_COUNT; e++) {
+        state.counters[i].events[e] = __atomic_load_n(&shm->counters[i].events[e], __ATOMIC_RELAXED);
+      }
+      state.counters[i].last_clicks = __atomic_load_n(&shm->counters[i].last_clicks, __ATOMIC_RELAXED);
+    }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    seq2 = __atomic_load_n(&shm->seq, __ATOMIC_RELAXED);
+  } while ((seq1 & 1) || seq1 != seq2);
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Returns the next event since begin() or the previous call.
+// Events overwritten before they were read are counted as lost.
+bool Button2ShmReader::nextEvent(Button2ShmEvent &ev) {
+  if (shm == NULL) return false;
+
+  while (true) {
+    uint32_t head = __atomic_load_n(&shm->event_head, __ATOMIC_ACQUIRE);
+    if (cursor == head) return false;
+    if (head - cursor > BUTTON2_SHM_RING_SIZE) {
+      lost += head - cursor - BUTTON2_SHM_RING_SIZE;
+      cursor = head - BUTTON2_SHM_RING_SIZE;
+    }
+
+    const Button2ShmEvent &slot = shm->ring[cursor & (BUTTON2_SHM_RING_SIZE - 1)];
+    uint32_t seq1 = __atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE);
+    ev.time_ms = __atomic_load_n(&slot.time_ms, __ATOMIC_RELAXED);
+    ev.button = __atomic_load_n(&slot.button, __ATOMIC_RELAXED);
+    ev.type = __atomic_load_n(&slot.type, __ATOMIC_RELAXED);
+    ev.clicks = __atomic_load_n(&slot.clicks, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint32_t seq2 = __atomic_load_n(&slot.seq, __ATOMIC_RELAXED);
+
+    cursor++;
+    if (seq1 == cursor && seq2 == seq1) {
+      ev.seq = seq1;
+      return true;
+    }
+    // the writer lapped us while reading this slot
+    lost++;
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint32_t Button2ShmReader::getLostEvents() const {
+  return lost;
+}
+
+/////////////////////////////////////////////////////////////////
+#endif
+/////////////////////////////////////////////////////////////////
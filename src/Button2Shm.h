@@ -0,0 +1,141 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Shm.h - Shared-memory state export for Button2 on Linux.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+
+  Publishes the debounced pressed bitmap, per-button event counters
+  and an event ring of a bank of buttons into a POSIX shared-memory
+  segment. Other processes map the segment read-only and observe the
+  buttons without syscalls or copies through the kernel.
+*/
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef Button2Shm_h
+#define Button2Shm_h
+
+/////////////////////////////////////////////////////////////////
+
+#include "Button2.h"
+
+#ifndef BUTTON2_HAS_SHM
+#if defined(__linux__)
+#define BUTTON2_HAS_SHM 1
+#endif
+#endif
+
+#ifdef BUTTON2_HAS_SHM
+
+/////////////////////////////////////////////////////////////////
+
+#define BUTTON2_SHM_MAGIC         0x42325348UL  // "B2SH"
+#define BUTTON2_SHM_VERSION       1
+#define BUTTON2_SHM_MAX_BUTTONS   64
+
+// must be a power of two
+#ifndef BUTTON2_SHM_RING_SIZE
+#define BUTTON2_SHM_RING_SIZE 256
+#endif
+
+/////////////////////////////////////////////////////////////////
+// Segment layout, shared between writer and readers.
+// All fields that change after creation are accessed atomically.
+
+struct Button2ShmCounters {
+  uint32_t events[BTN_EVENT_COUNT];  // indexed by buttonEvent
+  uint32_t last_clicks;              // getNumberOfClicks() of the last click
+};
+
+struct Button2ShmEvent {
+  uint32_t seq;        // index + 1 when the slot is valid, 0 while written
+  uint32_t time_ms;    // getEventTime() of the button, in ms
+  uint16_t button;     // index of the button in the bank
+  uint8_t type;        // buttonEvent
+  uint8_t clicks;      // number of clicks (click events only)
+};
+
+struct Button2ShmSegment {
+  // static part, written once before readers can see the segment
+  uint32_t magic;
+  uint16_t version;
+  uint16_t button_count;
+  uint32_t ring_size;
+  int32_t button_ids[BUTTON2_SHM_MAX_BUTTONS];
+
+  // seqlock protecting pressed + counters
+  uint32_t seq;
+  uint64_t pressed;  // bit n = button n is pressed (debounced)
+  Button2ShmCounters counters[BUTTON2_SHM_MAX_BUTTONS];
+
+  // event ring, event_head = number of events written so far
+  uint32_t event_head;
+  Button2ShmEvent ring[BUTTON2_SHM_RING_SIZE];
+};
+
+/////////////////////////////////////////////////////////////////
+// Writer: owns the segment and listens to the events of its buttons
+
+#define BUTTON2_SHM_MAX_NAME 64
+
+class Button2ShmPublisher : public Button2Listener {
+ protected:
+  Button2ShmSegment* shm = NULL;
+  Button2* buttons[BUTTON2_SHM_MAX_BUTTONS];
+  Button2ListenerLink links[BUTTON2_SHM_MAX_BUTTONS];
+  char name[BUTTON2_SHM_MAX_NAME];
+  uint8_t button_count = 0;
+
+  void onButtonEvent(Button2 &btn, buttonEvent ev) override;
+  void _onEvent(uint8_t index, Button2 &btn, buttonEvent ev);
+
+ public:
+  ~Button2ShmPublisher();
+
+  bool begin(const char* segmentName);
+  void end();
+  bool isOpen() const;
+  static bool removeSegment(const char* segmentName);
+
+  bool add(Button2 &btn);
+  uint8_t getButtonCount() const;
+};
+
+/////////////////////////////////////////////////////////////////
+// Reader: maps an existing segment read-only
+
+struct Button2ShmState {
+  uint64_t pressed;
+  uint16_t button_count;
+  Button2ShmCounters counters[BUTTON2_SHM_MAX_BUTTONS];
+};
+
+class Button2ShmReader {
+ protected:
+  const Button2ShmSegment* shm = NULL;
+  uint32_t cursor = 0;
+  uint32_t lost = 0;
+
+ public:
+  ~Button2ShmReader();
+
+  bool begin(const char* segmentName);
+  void end();
+  bool isOpen() const;
+
+  uint16_t getButtonCount() const;
+  int getButtonID(uint16_t index) const;
+
+  uint64_t getPressed() const;
+  bool isPressed(uint16_t index) const;
+  void read(Button2ShmState &state) const;
+
+  bool nextEvent(Button2ShmEvent &ev);
+  uint32_t getLostEvents() const;
+};
+
+/////////////////////////////////////////////////////////////////
+#endif
+#endif
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,362 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Stats.cpp - Runtime instrumentation for Button2.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+*/
+/////////////////////////////////////////////////////////////////
+
+#include "Button2Stats.h"
+
+/////////////////////////////////////////////////////////////////
+// receiver of the dispatch hook
+
+static Button2Profiler* active_profiler = NULL;
+static Button2LatencyMonitor* active_latency = NULL;
+
+static void _onDispatch(Button2 &btn, buttonEvent ev, unsigned long handler_time, unsigned long event_handler_time) {
+  if (active_profiler != NULL) active_profiler->record(btn, ev, handler_time, event_handler_time);
+  if (active_latency != NULL) active_latency->record(btn, ev);
+}
+
+// the hook stays installed while one of them is active
+static void _updateDispatchHook() {
+  if (active_profiler != NULL || active_latency != NULL) {
+    Button2::setDispatchHook(_onDispatch);
+  } else {
+    Button2::setDispatchHook(BUTTON2_NULL);
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+// Button2Histogram
+/////////////////////////////////////////////////////////////////
+
+void Button2Histogram::add(unsigned long value) {
+  uint8_t b = bucketOf(value);
+  if (buckets[b] < 0xFFFF) buckets[b]++;
+  count++;
+  total += value;
+  if (value < min_value) min_value = value;
+  if (value > max_value) max_value = value;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2Histogram::reset() {
+  for (uint8_t i = 0; i < BUTTON2_HISTOGRAM_BUCKETS; i++) buckets[i] = 0;
+  count = 0;
+  total = 0;
+  min_value = (unsigned long)-1;
+  max_value = 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint32_t Button2Histogram::getCount() const {
+  return count;
+}
+
+/////////////////////////////////////////////////////////////////
+
+unsigned long Button2Histogram::getTotal() const {
+  return total;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// 0 if nothing was recorded
+unsigned long Button2Histogram::getMin() const {
+  return (count > 0) ? min_value : 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+unsigned long Button2Histogram::getMax() const {
+  return max_value;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Upper limit of the bucket that holds the percentile, e.g. 99 for
+// the p99. Exact to a factor of two, never above the maximum.
+unsigned long Button2Histogram::getPercentile(uint8_t percent) const {
+  uint32_t sum = 0;
+  for (uint8_t i = 0; i < BUTTON2_HISTOGRAM_BUCKETS; i++) sum += buckets[i];
+  if (sum == 0) return 0;
+
+  // rank of the value, rounded up
+  uint32_t rank = (sum * percent + 99) / 100;
+  if (rank == 0) rank = 1;
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < BUTTON2_HISTOGRAM_BUCKETS; i++) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      unsigned long limit = bucketLimit(i);
+      return (limit < max_value) ? limit : max_value;
+    }
+  }
+  return max_value;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint16_t Button2Histogram::getBucket(uint8_t bucket) const {
+  return (bucket < BUTTON2_HISTOGRAM_BUCKETS) ? buckets[bucket] : 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Number of significant bits, capped at the last bucket
+uint8_t Button2Histogram::bucketOf(unsigned long value) {
+  uint8_t b = 0;
+  while (value > 0 && b < BUTTON2_HISTOGRAM_BUCKETS - 1) {
+    value >>= 1;
+    b++;
+  }
+  return b;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Largest value of a bucket
+unsigned long Button2Histogram::bucketLimit(uint8_t bucket) {
+  if (bucket >= BUTTON2_HISTOGRAM_BUCKETS - 1 || bucket >= sizeof(unsigned long) * 8) return (unsigned long)-1;
+  return (1UL << bucket) - 1;
+}
+
+/////////////////////////////////////////////////////////////////
+// Button2LoopMonitor
+/////////////////////////////////////////////////////////////////
+
+#ifndef BUTTON2_TICK_MS
+
+void Button2LoopMonitor::begin(Button2 &btn) {
+  button = &btn;
+  reset();
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2LoopMonitor::loop() {
+  if (button == NULL) return;
+  record();
+  button->loop();
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Records the time since the previous call. Gaps longer than the
+// debounce time let bounces through or drop short presses, gaps
+// longer than the double click window can merge or lose clicks.
+void Button2LoopMonitor::record() {
+  if (button == NULL) return;
+
+  unsigned long now = button->getTime();
+  if (started) {
+    unsigned long gap = now - last_loop;
+    gaps.add(gap);
+    if (gap > (unsigned long)button->getDebounceTime() * BUTTON2_TIME_PER_MS && debounce_misses < 0xFFFF) {
+      debounce_misses++;
+    }
+    if (gap > (unsigned long)button->getDoubleClickTime() * BUTTON2_TIME_PER_MS && doubleclick_misses < 0xFFFF) {
+      doubleclick_misses++;
+    }
+  }
+  last_loop = now;
+  started = true;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2LoopMonitor::reset() {
+  gaps.reset();
+  debounce_misses = 0;
+  doubleclick_misses = 0;
+  started = false;
+}
+
+/////////////////////////////////////////////////////////////////
+
+const Button2Histogram& Button2LoopMonitor::getHistogram() const {
+  return gaps;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint16_t Button2LoopMonitor::getDebounceMisses() const {
+  return debounce_misses;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint16_t Button2LoopMonitor::getDoubleClickMisses() const {
+  return doubleclick_misses;
+}
+
+#endif
+
+/////////////////////////////////////////////////////////////////
+// Button2Profiler
+/////////////////////////////////////////////////////////////////
+
+void Button2Profiler::begin() {
+  reset();
+  active_profiler = this;
+  _updateDispatchHook();
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2Profiler::end() {
+  if (active_profiler != this) return;
+  active_profiler = NULL;
+  _updateDispatchHook();
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2Profiler::reset() {
+  slot_count = 0;
+  untracked = 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Calls `f` with the handler and its time whenever a handler takes
+// longer than `time`. 0 turns the alarm off.
+void Button2Profiler::setBudget(unsigned long time, BudgetCallbackFunction f) {
+  budget = time;
+  budget_cb = BUTTON2_MOVE(f);
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Adds the times of the handlers of one event: the specific handler
+// and the event handler, each BTN_NOT_CALLED if not set. Handlers
+// beyond BUTTON2_PROFILER_SLOTS are only counted by getUntracked().
+void Button2Profiler::record(Button2 &btn, buttonEvent ev, unsigned long handler_time, unsigned long event_handler_time) {
+  if (handler_time != BTN_NOT_CALLED) _record(btn, ev, ev, handler_time);
+  if (event_handler_time != BTN_NOT_CALLED) _record(btn, BTN_EVENT_COUNT, ev, event_handler_time);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2Profiler::_record(Button2 &btn, uint8_t slot_event, buttonEvent ev, unsigned long time) {
+  Slot* slot = (Slot*)_find(btn, slot_event);
+  if (slot == NULL && slot_count < BUTTON2_PROFILER_SLOTS) {
+    slot = &slots[slot_count++];
+    slot->times.reset();
+    slot->button = &btn;
+    slot->event = slot_event;
+    slot->overruns = 0;
+  }
+  if (slot == NULL) {
+    if (untracked < 0xFFFF) untracked++;
+  } else {
+    slot->times.add(time);
+  }
+
+  if (budget == 0 || time <= budget) return;
+  if (slot != NULL && slot->overruns < 0xFFFF) slot->overruns++;
+  if (budget_cb != BUTTON2_NULL) budget_cb(btn, ev, time);
+}
+
+/////////////////////////////////////////////////////////////////
+
+const Button2Profiler::Slot* Button2Profiler::_find(const Button2 &btn, uint8_t event) const {
+  for (uint8_t i = 0; i < slot_count; i++) {
+    if (slots[i].button == &btn && slots[i].event == event) return &slots[i];
+  }
+  return NULL;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Count, total, max and histogram of a handler, NULL if it never ran
+const Button2Histogram* Button2Profiler::getStats(const Button2 &btn, buttonEvent ev) const {
+  const Slot* slot = _find(btn, ev);
+  return (slot != NULL) ? &slot->times : NULL;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint16_t Button2Profiler::getOverruns(const Button2 &btn, buttonEvent ev) const {
+  const Slot* slot = _find(btn, ev);
+  return (slot != NULL) ? slot->overruns : 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Same for the event handler of a button, over all events
+const Button2Histogram* Button2Profiler::getEventHandlerStats(const Button2 &btn) const {
+  const Slot* slot = _find(btn, BTN_EVENT_COUNT);
+  return (slot != NULL) ? &slot->times : NULL;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint16_t Button2Profiler::getEventHandlerOverruns(const Button2 &btn) const {
+  const Slot* slot = _find(btn, BTN_EVENT_COUNT);
+  return (slot != NULL) ? slot->overruns : 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint16_t Button2Profiler::getUntracked() const {
+  return untracked;
+}
+
+/////////////////////////////////////////////////////////////////
+// Button2LatencyMonitor
+/////////////////////////////////////////////////////////////////
+
+void Button2LatencyMonitor::begin() {
+  reset();
+  active_latency = this;
+  _updateDispatchHook();
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2LatencyMonitor::end() {
+  if (active_latency != this) return;
+  active_latency = NULL;
+  _updateDispatchHook();
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2LatencyMonitor::reset() {
+  for (uint8_t i = 0; i < BTN_EVENT_COUNT; i++) {
+    latencies[i].reset();
+    waits[i].reset();
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Adds the delay of the handler call past the time the event became
+// due, and the wait from the edge behind the event to that time, see
+// Button2::getEventTime(), getEventDueTime() and getEdgeTime(). Kept
+// apart, so a long click detection doesn't count its hold time and a
+// click its double click window as latency.
+void Button2LatencyMonitor::record(Button2 &btn, buttonEvent ev) {
+  if (ev >= BTN_EVENT_COUNT) return;
+  latencies[ev].add((button2_time_t)(btn.getEventTime() - btn.getEventDueTime()));
+  waits[ev].add((button2_time_t)(btn.getEventDueTime() - btn.getEdgeTime()));
+}
+
+/////////////////////////////////////////////////////////////////
+
+const Button2Histogram& Button2LatencyMonitor::getLatency(buttonEvent ev) const {
+  return latencies[(ev < BTN_EVENT_COUNT) ? ev : 0];
+}
+
+/////////////////////////////////////////////////////////////////
+
+const Button2Histogram& Button2LatencyMonitor::getWait(buttonEvent ev) const {
+  return waits[(ev < BTN_EVENT_COUNT) ? ev : 0];
+}
+
+/////////////////////////////////////////////////////////////////
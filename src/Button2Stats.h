@@ -0,0 +1,166 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Stats.h - Runtime instrumentation for Button2.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+
+  Opt-in measurements for production firmware, nothing is recorded
+  unless one of the classes below is used:
+  - Button2Histogram: log2-bucketed histogram with min/max/percentiles
+  - Button2LoopMonitor: the interval between loop() calls, and how
+    often it was longer than the debounce or double click time
+  - Button2Profiler: the time each handler takes, with a budget alarm
+  - Button2LatencyMonitor: the delay of the handler calls past the
+    time the events became due, and the wait built into the events,
+    per event type
+*/
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef Button2Stats_h
+#define Button2Stats_h
+
+/////////////////////////////////////////////////////////////////
+
+#include "Button2.h"
+
+/////////////////////////////////////////////////////////////////
+
+// bucket 0 holds 0, bucket i values from 2^(i-1) to 2^i - 1,
+// the last one everything above
+#ifndef BUTTON2_HISTOGRAM_BUCKETS
+#define BUTTON2_HISTOGRAM_BUCKETS 16
+#endif
+
+// handlers the profiler keeps numbers for, by default all handlers of
+// one button: one per event plus the event handler
+#ifndef BUTTON2_PROFILER_SLOTS
+#define BUTTON2_PROFILER_SLOTS (BTN_EVENT_COUNT + 1)
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+class Button2Histogram {
+ protected:
+  unsigned long total = 0;
+  unsigned long min_value = (unsigned long)-1;
+  unsigned long max_value = 0;
+  uint32_t count = 0;
+  uint16_t buckets[BUTTON2_HISTOGRAM_BUCKETS] = {};   // saturate at 65535
+
+ public:
+  void add(unsigned long value);
+  void reset();
+
+  uint32_t getCount() const;
+  unsigned long getTotal() const;
+  unsigned long getMin() const;
+  unsigned long getMax() const;
+  unsigned long getPercentile(uint8_t percent) const;
+  uint16_t getBucket(uint8_t bucket) const;
+
+  static uint8_t bucketOf(unsigned long value);
+  static unsigned long bucketLimit(uint8_t bucket);
+};
+
+/////////////////////////////////////////////////////////////////
+
+#ifndef BUTTON2_TICK_MS
+
+class Button2LoopMonitor {
+ protected:
+  Button2Histogram gaps;
+  Button2* button = NULL;
+  unsigned long last_loop = 0;
+  uint16_t debounce_misses = 0;
+  uint16_t doubleclick_misses = 0;
+  bool started = false;
+
+ public:
+  void begin(Button2 &btn);
+
+  // Call instead of the button's loop(), or call record() once per
+  // iteration of your main loop if something else runs the button
+  void loop();
+  void record();
+  void reset();
+
+  // intervals in the button's clock units: ms, or us with BUTTON2_USE_MICROS
+  const Button2Histogram& getHistogram() const;
+  uint16_t getDebounceMisses() const;
+  uint16_t getDoubleClickMisses() const;
+};
+
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+class Button2Profiler {
+ protected:
+#ifdef BUTTON2_HAS_STD_FUNCTION
+  typedef std::function<void(Button2 &btn, buttonEvent ev, unsigned long time)> BudgetCallbackFunction;
+#else
+  typedef void (*BudgetCallbackFunction)(Button2 &, buttonEvent, unsigned long);
+#endif
+
+  // the event handler of a button has one slot for all events,
+  // with BTN_EVENT_COUNT as its event
+  struct Slot {
+    Button2Histogram times;
+    const Button2* button;
+    uint16_t overruns;
+    uint8_t event;
+  };
+
+  Slot slots[BUTTON2_PROFILER_SLOTS];
+  BudgetCallbackFunction budget_cb = BUTTON2_NULL;
+  unsigned long budget = 0;
+  uint16_t untracked = 0;
+  uint8_t slot_count = 0;
+
+  const Slot* _find(const Button2 &btn, uint8_t event) const;
+  void _record(Button2 &btn, uint8_t slot_event, buttonEvent ev, unsigned long time);
+
+ public:
+  // Installs Button2::setDispatchHook() for all buttons, one profiler
+  // at a time. end() removes it again.
+  void begin();
+  void end();
+  void reset();
+
+  // Times are in BUTTON2_PROFILE_CLOCK() units, us by default
+  void setBudget(unsigned long time, BudgetCallbackFunction f);
+  void record(Button2 &btn, buttonEvent ev, unsigned long handler_time, unsigned long event_handler_time);
+
+  const Button2Histogram* getStats(const Button2 &btn, buttonEvent ev) const;
+  uint16_t getOverruns(const Button2 &btn, buttonEvent ev) const;
+  const Button2Histogram* getEventHandlerStats(const Button2 &btn) const;
+  uint16_t getEventHandlerOverruns(const Button2 &btn) const;
+  uint16_t getUntracked() const;
+};
+
+/////////////////////////////////////////////////////////////////
+
+class Button2LatencyMonitor {
+ protected:
+  Button2Histogram latencies[BTN_EVENT_COUNT];
+  Button2Histogram waits[BTN_EVENT_COUNT];
+
+ public:
+  // Shares Button2::setDispatchHook() with the profiler, both can run
+  // at the same time. end() removes it again.
+  void begin();
+  void end();
+  void reset();
+
+  void record(Button2 &btn, buttonEvent ev);
+
+  // in the button's clock units: ms, or us with BUTTON2_USE_MICROS
+  const Button2Histogram& getLatency(buttonEvent ev) const;
+  const Button2Histogram& getWait(buttonEvent ev) const;
+};
+
+/////////////////////////////////////////////////////////////////
+#endif
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,205 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Trace.cpp - Raw input trace recorder for Button2.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+*/
+/////////////////////////////////////////////////////////////////
+
+#include "Button2Trace.h"
+
+/////////////////////////////////////////////////////////////////
+// receiver of the trace hook
+
+static Button2TraceRecorder* active_recorder = NULL;
+
+static void _onTrace(Button2 &btn, uint8_t level, unsigned long time) {
+  if (active_recorder != NULL) active_recorder->record(btn, level, time);
+}
+
+/////////////////////////////////////////////////////////////////
+
+// 7 bits per byte, lowest first, returns the number of bytes
+static uint8_t _encode(unsigned long value, uint8_t* out) {
+  uint8_t len = 0;
+  while (value >= 0x80) {
+    out[len++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[len++] = (uint8_t)value;
+  return len;
+}
+
+/////////////////////////////////////////////////////////////////
+// Button2TraceRecorder
+/////////////////////////////////////////////////////////////////
+
+void Button2TraceRecorder::begin() {
+  clear();
+  active_recorder = this;
+  Button2::setTraceHook(_onTrace);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2TraceRecorder::end() {
+  if (active_recorder != this) return;
+  active_recorder = NULL;
+  Button2::setTraceHook(BUTTON2_NULL);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2TraceRecorder::clear() {
+  head = 0;
+  used = 0;
+  records = 0;
+  dropped = 0;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Appends one change, dropping the oldest records if the buffer is full.
+// The delta is taken in button2_time_t, so the 16 bit tick clock may wrap.
+void Button2TraceRecorder::record(const Button2 &btn, uint8_t level, unsigned long time) {
+  if (used == 0) base_time = last_time = time;
+  button2_time_t delta = (button2_time_t)(time - last_time);
+  last_time += delta;
+
+  uint8_t bytes[8];
+  uint8_t len = _encode(((unsigned long)(uint16_t)btn.getID() << 1) | (level ? 1 : 0), bytes);
+  len += _encode(delta, bytes + len);
+
+  while (BUTTON2_TRACE_SIZE - used < len) _dropOldest();
+  _put(bytes, len);
+  if (records < 0xFFFF) records++;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void Button2TraceRecorder::_put(uint8_t* bytes, uint8_t len) {
+  for (uint8_t i = 0; i < len; i++) {
+    buffer[head] = bytes[i];
+    head = (head + 1) % BUTTON2_TRACE_SIZE;
+  }
+  used += len;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Byte `offset` counted from the oldest one
+uint8_t Button2TraceRecorder::_at(uint16_t offset) const {
+  return buffer[(head + BUTTON2_TRACE_SIZE - used + offset) % BUTTON2_TRACE_SIZE];
+}
+
+/////////////////////////////////////////////////////////////////
+
+// The next record's delta now starts from the dropped one's time
+void Button2TraceRecorder::_dropOldest() {
+  uint16_t pos = 0;
+  // skip the ID and level
+  while (pos < used && (_at(pos) & 0x80)) pos++;
+  pos++;
+  unsigned long delta = 0;
+  uint8_t shift = 0;
+  while (pos < used) {
+    uint8_t b = _at(pos++);
+    delta |= (unsigned long)(b & 0x7F) << shift;
+    shift += 7;
+    if (!(b & 0x80)) break;
+  }
+  base_time += delta;
+  used = (pos < used) ? used - pos : 0;
+  if (records > 0) records--;
+  if (dropped < 0xFFFF) dropped++;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint16_t Button2TraceRecorder::getRecords() const {
+  return records;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint16_t Button2TraceRecorder::getDroppedRecords() const {
+  return dropped;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Bytes in use
+uint16_t Button2TraceRecorder::getSize() const {
+  return used;
+}
+
+/////////////////////////////////////////////////////////////////
+
+unsigned long Button2TraceRecorder::getBaseTime() const {
+  return base_time;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Copies the records, oldest first, returns the number of bytes
+uint16_t Button2TraceRecorder::copyTo(uint8_t* out, uint16_t size) const {
+  uint16_t len = (size < used) ? size : used;
+  for (uint16_t i = 0; i < len; i++) out[i] = _at(i);
+  return len;
+}
+
+/////////////////////////////////////////////////////////////////
+
+// One line: B2T1,<base time>,<dropped records>,<hex bytes>
+void Button2TraceRecorder::dump(Print &out) const {
+  static const char hex[] = "0123456789abcdef";
+  out.print("B2T1,");
+  out.print(base_time);
+  out.print(',');
+  out.print((unsigned int)dropped);
+  out.print(',');
+  for (uint16_t i = 0; i < used; i++) {
+    uint8_t b = _at(i);
+    out.print(hex[b >> 4]);
+    out.print(hex[b & 0x0F]);
+  }
+  out.println();
+}
+
+/////////////////////////////////////////////////////////////////
+// Button2TraceReader
+/////////////////////////////////////////////////////////////////
+
+Button2TraceReader::Button2TraceReader(const uint8_t* bytes, uint16_t len, unsigned long base_time) {
+  data = bytes;
+  size = len;
+  time = base_time;
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2TraceReader::_varint(unsigned long &value) {
+  value = 0;
+  uint8_t shift = 0;
+  while (pos < size && shift < 35) {
+    uint8_t b = data[pos++];
+    value |= (unsigned long)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+    shift += 7;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////////////////////
+
+bool Button2TraceReader::next(Button2TraceRecord &rec) {
+  unsigned long tag, delta;
+  if (!_varint(tag) || !_varint(delta)) return false;
+  time += delta;
+  rec.time = time;
+  rec.id = (uint16_t)(tag >> 1);
+  rec.level = tag & 1;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,104 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Button2Trace.h - Raw input trace recorder for Button2.
+  Copyright (C) 2017-2026 Lennart Hennigs.
+  Released under the MIT license.
+
+  Records every change of the raw input of all buttons (before it is
+  debounced) with its time and the button's ID into a RAM ring buffer,
+  for field debugging. A record takes 2-3 bytes: the ID and level, and
+  the time since the previous record, both as varints (7 bits per byte,
+  the high bit marks that another byte follows). When the buffer is
+  full the oldest records are dropped. Nothing is recorded while the
+  input is quiet, so it can stay on in production.
+
+  dump() prints the buffer as one line of text:
+    B2T1,<base time>,<dropped records>,<hex bytes>
+  extras/trace2csv.py turns such lines into CSV (time,id,level),
+  Button2TraceReader decodes them on the device.
+*/
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef Button2Trace_h
+#define Button2Trace_h
+
+/////////////////////////////////////////////////////////////////
+
+#include "Button2.h"
+
+/////////////////////////////////////////////////////////////////
+
+// bytes of the ring buffer, at most 32768
+#ifndef BUTTON2_TRACE_SIZE
+#define BUTTON2_TRACE_SIZE 256
+#endif
+
+#if BUTTON2_TRACE_SIZE < 16 || BUTTON2_TRACE_SIZE > 32768
+#error "BUTTON2_TRACE_SIZE must be between 16 and 32768"
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+struct Button2TraceRecord {
+  unsigned long time;   // the button's clock, see Button2::getTime()
+  uint16_t id;          // Button2::getID()
+  uint8_t level;        // raw level after the change
+};
+
+/////////////////////////////////////////////////////////////////
+
+class Button2TraceRecorder {
+ protected:
+  uint8_t buffer[BUTTON2_TRACE_SIZE];
+  unsigned long base_time = 0;   // time the oldest record's delta starts from
+  unsigned long last_time = 0;   // time of the newest record
+  uint16_t head = 0;             // next byte to write
+  uint16_t used = 0;             // bytes in the buffer
+  uint16_t records = 0;
+  uint16_t dropped = 0;
+
+  void _put(uint8_t* bytes, uint8_t len);
+  void _dropOldest();
+  uint8_t _at(uint16_t offset) const;
+
+ public:
+  // Installs Button2::setTraceHook() for all buttons, one recorder at
+  // a time. end() removes it again.
+  void begin();
+  void end();
+  void clear();
+
+  void record(const Button2 &btn, uint8_t level, unsigned long time);
+
+  uint16_t getRecords() const;
+  uint16_t getDroppedRecords() const;
+  uint16_t getSize() const;
+  unsigned long getBaseTime() const;
+  uint16_t copyTo(uint8_t* out, uint16_t size) const;
+  void dump(Print &out) const;
+};
+
+/////////////////////////////////////////////////////////////////
+
+// Decodes the bytes of a recorder, e.g. from copyTo() or a dump
+class Button2TraceReader {
+ protected:
+  const uint8_t* data;
+  unsigned long time;
+  uint16_t size;
+  uint16_t pos = 0;
+
+  bool _varint(unsigned long &value);
+
+ public:
+  Button2TraceReader(const uint8_t* bytes, uint16_t len, unsigned long base_time);
+
+  // false at the end of the data or on a truncated record
+  bool next(Button2TraceRecord &rec);
+};
+
+/////////////////////////////////////////////////////////////////
+#endif
+/////////////////////////////////////////////////////////////////
@@ -7,6 +7,13 @@
     1. simulatedPinState = !BUTTON_ACTIVE
     2. button.setButtonStateFunction(getSimulatedPinState)
     3. button.begin(...)
+
+  Test clock: suites that call useTestClock() run on a virtual clock
+  (via Button2::setTimeFunction()). testDelay() advances it instead of
+  sleeping, so the timing tests finish in no time and every run sees
+  exactly the same times. Built with -DBUTTON2_TEST_REAL_TIME they run
+  on millis() and delay(), except for suites with scripted times
+  (useTestClock(start)), which need the virtual clock.
 */
 /////////////////////////////////////////////////////////////////
 
@@ -33,6 +40,49 @@ uint8_t getSimulatedPinState() {
 
 /////////////////////////////////////////////////////////////////
 
+// in the button's clock units: ms, or us with BUTTON2_USE_MICROS,
+// which wraps at 2^32 like micros() on the targets
+#ifdef BUTTON2_USE_MICROS
+static uint32_t virtualTime = 0;
+#else
+static unsigned long virtualTime = 0;
+#endif
+static bool virtualClock = false;
+
+unsigned long getVirtualTime() {
+  return virtualTime;
+}
+
+inline void useTestClock() {
+#ifndef BUTTON2_TEST_REAL_TIME
+  virtualClock = true;
+  Button2::setTimeFunction(getVirtualTime);
+#endif
+}
+
+// For tests with scripted times: the virtual clock set to `start`, in
+// any build
+inline void useTestClock(unsigned long start) {
+  virtualClock = true;
+  virtualTime = start;
+  Button2::setTimeFunction(getVirtualTime);
+}
+
+// millis() and delay() of the test clock
+inline unsigned long testMillis() {
+  return virtualClock ? virtualTime / BUTTON2_TIME_PER_MS : millis();
+}
+
+inline void testDelay(unsigned long ms) {
+  if (virtualClock) {
+    virtualTime += ms * BUTTON2_TIME_PER_MS;
+  } else {
+    delay(ms);
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
 // Correct order: set state → setButtonStateFunction → begin
 inline Button2 createTestButton() {
   Button2 button;
@@ -49,10 +99,10 @@ inline void pressAndHold(Button2& button, unsigned long duration) {
   simulatedPinState = BUTTON_ACTIVE;
   button.loop();
 
-  unsigned long end = millis() + duration;
-  while (millis() < end) {
+  unsigned long end = testMillis() + duration;
+  while (testMillis() < end) {
     button.loop();
-    delay(1);
+    testDelay(1);
   }
 }
 
@@ -61,20 +111,29 @@ inline void click(Button2& button, unsigned long duration) {
   pressAndHold(button, duration);
   simulatedPinState = !BUTTON_ACTIVE;
   button.loop();
-  delay(5);
+  testDelay(5);
   button.loop();
 }
 
 inline void press(Button2& button) {
   simulatedPinState = BUTTON_ACTIVE;
-  delay(5);
+  testDelay(5);
   button.loop();
 }
 
 inline void release(Button2& button) {
   simulatedPinState = !BUTTON_ACTIVE;
-  delay(5);
+  testDelay(5);
   button.loop();
 }
 
+// Keep `level` for `ms`, with a loop() every 5ms
+inline void run(Button2& button, uint8_t level, unsigned long ms) {
+  simulatedPinState = level;
+  for (unsigned long t = 0; t < ms; t += 5) {
+    button.loop();
+    testDelay(5);
+  }
+}
+
 /////////////////////////////////////////////////////////////////
@@ -159,6 +159,7 @@ test(init_callback, lambda_callback) {
 
 void setup() {
   setup_test_runner();
+  useTestClock();
 
   // setup serial (reduced delay for faster native testing)
   delay(100);
@@ -0,0 +1,207 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Bounce statistics tests for Button2 library.
+  Tests the bounce train measurements of setBounceStats() and the
+  auto-tuned debounce time.
+
+  Created by Lennart Hennigs
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+
+static int pressedCalls;
+static ButtonExtension extension;
+
+Button2 createBounceButton() {
+  useTestClock(1000);
+  Button2 button = createTestButton();
+  extension = ButtonExtension();
+  button.setExtension(&extension);
+  pressedCalls = 0;
+  button.setPressedHandler([](Button2& btn) { pressedCalls++; });
+  return button;
+}
+
+#define PRESSED   BUTTON_ACTIVE
+#define RELEASED  !BUTTON_ACTIVE
+
+// an edge every 5ms towards `level`, `edges` (odd) in total
+void bounce(Button2& button, uint8_t level, uint8_t edges) {
+  for (uint8_t i = 0; i < edges; i++) {
+    run(button, (i % 2) ? !level : level, 5);
+  }
+}
+
+// presses that bounce for 10ms (3 edges) on both edges
+void dirtyPresses(Button2& button, uint8_t count) {
+  for (uint8_t i = 0; i < count; i++) {
+    bounce(button, PRESSED, 3);
+    run(button, PRESSED, 100);
+    bounce(button, RELEASED, 3);
+    run(button, RELEASED, 100);
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+// BOUNCE TESTS
+/////////////////////////////////////////////////////////////////
+
+test(bounce, nothing_measured_by_default) {
+  Button2 button = createBounceButton();
+  dirtyPresses(button, 2);
+  assertEqual(button.getBounceTrains(), 0);
+  assertEqual(button.getRejectedEdges(), 0);
+  assertEqual(pressedCalls, 2);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(bounce, trains_measured) {
+  Button2 button = createBounceButton();
+  ButtonBounceStats stats;
+  button.setBounceStats(&stats);
+
+  dirtyPresses(button, 10);
+  // the debounce filter still sees one press each
+  assertEqual(pressedCalls, 10);
+  assertEqual(button.getBounceTrains(), 20);
+  assertEqual(button.getRejectedEdges(), 40);
+  assertEqual(button.getBounceTime(), 10UL);
+  assertEqual(button.getBounceDeviation(), 0UL);
+  assertEqual(button.getLongestBounce(), 10UL);
+  // tuning is off
+  assertEqual(button.getDebounceTime(), BTN_DEBOUNCE_MS);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(bounce, clean_edges_are_not_trains) {
+  Button2 button = createBounceButton();
+  ButtonBounceStats stats;
+  button.setBounceStats(&stats);
+
+  run(button, PRESSED, 100);
+  run(button, RELEASED, 100);
+  assertEqual(button.getBounceTrains(), 0);
+  assertEqual(button.getRejectedEdges(), 0);
+  assertEqual(button.getBounceTime(), 0UL);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(bounce, clean_edges_keep_the_window) {
+  Button2 button = createBounceButton();
+  ButtonBounceStats stats;
+  button.setBounceStats(&stats, true);
+
+  // a clean switch next to a few bouncing presses
+  for (uint8_t i = 0; i < 2 * BTN_AUTOTUNE_MIN_TRAINS; i++) {
+    run(button, PRESSED, 100);
+    run(button, RELEASED, 100);
+  }
+  assertEqual(button.getDebounceTime(), BTN_DEBOUNCE_MS);
+  dirtyPresses(button, BTN_AUTOTUNE_MIN_TRAINS / 2);
+  unsigned int tuned = button.getDebounceTime();
+  assertMore(tuned, 10U);
+  assertEqual(pressedCalls, 2 * BTN_AUTOTUNE_MIN_TRAINS + BTN_AUTOTUNE_MIN_TRAINS / 2);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(bounce, auto_tune_floor) {
+  Button2 button = createBounceButton();
+  ButtonBounceStats stats;
+  button.setBounceStats(&stats, true, 8);
+
+  // trains of 2ms, the estimate alone would give 3ms
+  for (uint8_t i = 0; i < BTN_AUTOTUNE_MIN_TRAINS; i++) {
+    simulatedPinState = PRESSED;
+    button.loop();
+    virtualTime += 1;
+    simulatedPinState = RELEASED;
+    button.loop();
+    virtualTime += 1;
+    run(button, PRESSED, 100);
+    run(button, RELEASED, 100);
+  }
+  assertEqual(button.getBounceTime(), 2UL);
+  assertEqual(button.getDebounceTime(), 8U);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(bounce, auto_tune_shrinks_debounce) {
+  Button2 button = createBounceButton();
+  ButtonBounceStats stats;
+  button.setBounceStats(&stats, true);
+
+  dirtyPresses(button, BTN_AUTOTUNE_MIN_TRAINS / 2 - 1);
+  assertEqual(button.getDebounceTime(), BTN_DEBOUNCE_MS);
+  dirtyPresses(button, 10);
+  // above the longest train, well below the default
+  unsigned int tuned = button.getDebounceTime();
+  assertMore(tuned, 10U);
+  assertLess(tuned, 20U);
+  assertEqual(pressedCalls, 3 + 10);
+  // presses shorter than the old window now count
+  run(button, PRESSED, 30);
+  run(button, RELEASED, 100);
+  assertEqual(pressedCalls, 14);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(bounce, auto_tune_capped) {
+  Button2 button = createBounceButton();
+  ButtonBounceStats stats;
+  button.setDebounceTime(30);
+  button.setBounceStats(&stats, true);
+
+  // bounces longer than the window that was set
+  for (uint8_t i = 0; i < BTN_AUTOTUNE_MIN_TRAINS; i++) {
+    bounce(button, PRESSED, 11);
+    run(button, PRESSED, 100);
+    run(button, RELEASED, 100);
+  }
+  assertEqual(button.getLongestBounce(), 50UL);
+  assertEqual(button.getDebounceTime(), 30U);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Bounce Statistics Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
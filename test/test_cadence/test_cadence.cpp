@@ -0,0 +1,204 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Adaptive double click tests for Button2 library.
+  Tests the click cadence learned by setAdaptiveDoubleClick() and the
+  double click window derived from it.
+
+  Created by Lennart Hennigs
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+
+static int clicks;
+static int doubleClicks;
+static ButtonExtension extension;
+
+Button2 createCadenceButton() {
+  useTestClock(1000);
+  Button2 button = createTestButton();
+  extension = ButtonExtension();
+  button.setExtension(&extension);
+  clicks = doubleClicks = 0;
+  button.setClickHandler([](Button2& btn) { clicks++; });
+  button.setDoubleClickHandler([](Button2& btn) { doubleClicks++; });
+  return button;
+}
+
+#define PRESSED   BUTTON_ACTIVE
+#define RELEASED  !BUTTON_ACTIVE
+#define HOLD_MS   (BTN_DEBOUNCE_MS + 10)
+
+// double clicks with `gap` ms from press to press
+void doubleClick(Button2& button, unsigned long gap, uint8_t count = 1) {
+  for (uint8_t i = 0; i < count; i++) {
+    run(button, PRESSED, HOLD_MS);
+    run(button, RELEASED, gap - HOLD_MS);
+    run(button, PRESSED, HOLD_MS);
+    run(button, RELEASED, 1000);
+  }
+}
+
+// the same with a bounce of each release
+void bouncyDoubleClick(Button2& button, unsigned long gap, uint8_t count = 1) {
+  for (uint8_t i = 0; i < count; i++) {
+    run(button, PRESSED, HOLD_MS);
+    run(button, RELEASED, 5);
+    run(button, PRESSED, 5);
+    run(button, RELEASED, gap - HOLD_MS - 10);
+    run(button, PRESSED, HOLD_MS);
+    run(button, RELEASED, 5);
+    run(button, PRESSED, 5);
+    run(button, RELEASED, 1000);
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+// CADENCE TESTS
+/////////////////////////////////////////////////////////////////
+
+test(cadence, window_fixed_by_default) {
+  Button2 button = createCadenceButton();
+  doubleClick(button, 150, 10);
+  assertEqual(doubleClicks, 10);
+  assertEqual(button.getDoubleClickTime(), BTN_DOUBLECLICK_MS);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(cadence, window_shrinks_to_cadence) {
+  Button2 button = createCadenceButton();
+  ButtonClickCadence learned;
+  button.setAdaptiveDoubleClick(&learned);
+
+  doubleClick(button, 150, BTN_CADENCE_MIN_SAMPLES - 1);
+  assertEqual(button.getDoubleClickTime(), BTN_DOUBLECLICK_MS);
+  doubleClick(button, 150, 20);
+  assertEqual(learned.samples, BTN_CADENCE_MIN_SAMPLES - 1 + 20);
+  assertEqual(doubleClicks, BTN_CADENCE_MIN_SAMPLES - 1 + 20);
+  unsigned int window = button.getDoubleClickTime();
+  assertMore(window, 150U);
+  assertLess(window, 200U);
+
+  // a single click is reported once the shorter window has passed
+  run(button, PRESSED, HOLD_MS);
+  run(button, RELEASED, window - HOLD_MS + 10);
+  assertEqual(clicks, 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(cadence, release_bounce_is_no_gap) {
+  Button2 button = createCadenceButton();
+  ButtonClickCadence learned;
+  button.setAdaptiveDoubleClick(&learned);
+
+  bouncyDoubleClick(button, 250, 20);
+  assertEqual(doubleClicks, 20);
+  assertEqual(clicks, 0);
+  assertEqual(learned.samples, 20);
+  // the gaps from press to press, not to the bounce
+  assertMoreOrEqual(learned.mean >> 4, 245UL);
+  assertLessOrEqual(learned.mean >> 4, 255UL);
+  assertMore(button.getDoubleClickTime(), 250U);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(cadence, slower_cadence_widens_window) {
+  Button2 button = createCadenceButton();
+  ButtonClickCadence learned;
+  button.setAdaptiveDoubleClick(&learned);
+  doubleClick(button, 120, 20);
+  assertLess(button.getDoubleClickTime(), 160U);
+
+  // gaps beyond the window but within the configured time are learned,
+  // the first of them end up as two single clicks
+  doubleClick(button, 260, 20);
+  assertMore(clicks, 0);
+  assertMore(button.getDoubleClickTime(), 260U);
+  int before = doubleClicks;
+  doubleClick(button, 260, 20);
+  assertEqual(doubleClicks, before + 20);
+  // and shrinks again once the cadence is steady
+  assertLess(button.getDoubleClickTime(), BTN_DOUBLECLICK_MS);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(cadence, cadence_restored) {
+  Button2 button = createCadenceButton();
+  ButtonClickCadence learned;
+  button.setAdaptiveDoubleClick(&learned);
+  doubleClick(button, 150, 20);
+
+  // e.g. written to EEPROM and read back after a reboot
+  uint8_t stored[sizeof(ButtonClickCadence)];
+  memcpy(stored, &learned, sizeof(stored));
+  ButtonClickCadence restored;
+  memcpy(&restored, stored, sizeof(restored));
+
+  ButtonExtension otherExtension;
+  Button2 other = createTestButton();
+  other.setExtension(&otherExtension);
+  other.setAdaptiveDoubleClick(&restored);
+  assertEqual(other.getDoubleClickTime(), button.getDoubleClickTime());
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(cadence, percent_sets_margin) {
+  Button2 button = createCadenceButton();
+  ButtonClickCadence learned;
+  button.setAdaptiveDoubleClick(&learned, 80);
+  for (uint8_t i = 0; i < 10; i++) {
+    doubleClick(button, 140);
+    doubleClick(button, 180);
+  }
+  unsigned int narrow = button.getDoubleClickTime();
+
+  ButtonExtension otherExtension;
+  Button2 other = createTestButton();
+  other.setExtension(&otherExtension);
+  other.setAdaptiveDoubleClick(&learned, 99);
+  assertMore(other.getDoubleClickTime(), narrow);
+  assertLessOrEqual(other.getDoubleClickTime(), BTN_DOUBLECLICK_MS);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Adaptive Double Click Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
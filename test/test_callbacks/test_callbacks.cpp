@@ -72,7 +72,7 @@ test(callbacks, pressed_handler) {
   // Press button
   simulatedPinState = BUTTON_ACTIVE;
   button.loop();
-  delay(DEBOUNCE_MS);
+  testDelay(DEBOUNCE_MS);
   button.loop();
 
   assertTrue(g_pressed);
@@ -130,7 +130,7 @@ test(callbacks, changed_handler) {
   // Press (should trigger changed)
   simulatedPinState = BUTTON_ACTIVE;
   button.loop();
-  delay(DEBOUNCE_MS);
+  testDelay(DEBOUNCE_MS);
   button.loop();
 
   assertTrue(g_changed);
@@ -139,7 +139,7 @@ test(callbacks, changed_handler) {
   // Release (should trigger changed again)
   simulatedPinState = !BUTTON_ACTIVE;
   button.loop();
-  delay(5);
+  testDelay(5);
   button.loop();
 
   assertEqual(g_changed_count, 2);
@@ -158,7 +158,7 @@ test(callbacks, click_handler) {
 
   // Single click
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   assertTrue(g_click);
@@ -178,7 +178,7 @@ test(callbacks, double_click_handler) {
   // Double click
   click(button, DEBOUNCE_MS);
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   assertTrue(g_double_click);
@@ -199,7 +199,7 @@ test(callbacks, triple_click_handler) {
   click(button, DEBOUNCE_MS);
   click(button, DEBOUNCE_MS);
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   assertTrue(g_triple_click);
@@ -207,6 +207,140 @@ test(callbacks, triple_click_handler) {
 
 /////////////////////////////////////////////////////////////////
 
+static int g_clicks_seen = 0;
+static int g_handler_called = 0;
+
+void clickTimes(Button2& button, uint8_t n) {
+  for (uint8_t i = 0; i < n; i++) click(button, DEBOUNCE_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
+  button.loop();
+}
+
+// needs -DBUTTON2_MAX_CLICK_HANDLERS=5
+#if BUTTON2_MAX_CLICK_HANDLERS >= 5
+test(callbacks, n_click_handler) {
+  resetHandlerVars();
+  Button2 button = createTestButton();
+  g_handler_called = 0;
+
+  button.setTripleClickHandler([](Button2& b) {
+    g_triple_click = true;
+  });
+  assertTrue(button.setClickHandler(4, [](Button2& b) {
+    g_handler_called = 4;
+  }));
+  assertTrue(button.setClickHandler(5, [](Button2& b) {
+    g_handler_called = 5;
+  }));
+
+  clickTimes(button, 4);
+  assertEqual(g_handler_called, 4);
+  assertFalse(g_triple_click);
+  assertEqual(button.getType(), triple_click);
+  assertEqual(button.getNumberOfClicks(), 4);
+
+  button.read();
+  clickTimes(button, 5);
+  assertEqual(g_handler_called, 5);
+  assertFalse(g_triple_click);
+}
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+test(callbacks, n_click_handler_up_to_max) {
+  resetHandlerVars();
+  Button2 button = createTestButton();
+  g_handler_called = 0;
+
+  assertTrue(button.setClickHandler(3, [](Button2& b) {
+    g_triple_click = true;
+  }));
+  // rejected above BUTTON2_MAX_CLICK_HANDLERS
+  assertFalse(button.setClickHandler(0, [](Button2& b) {
+    g_handler_called = 1;
+  }));
+  assertFalse(button.setClickHandler(BUTTON2_MAX_CLICK_HANDLERS + 1, [](Button2& b) {
+    g_handler_called = 4;
+  }));
+
+  clickTimes(button, BUTTON2_MAX_CLICK_HANDLERS + 1);
+
+  clickTimes(button, 4);
+  assertEqual(g_handler_called, 0);
+  assertTrue(g_triple_click);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(callbacks, triple_click_handler_catches_more_clicks) {
+  resetHandlerVars();
+  Button2 button = createTestButton();
+
+  button.setTripleClickHandler([](Button2& b) {
+    g_triple_click = true;
+  });
+
+  clickTimes(button, 4);
+  assertTrue(g_triple_click);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(callbacks, multi_click_handler) {
+  resetHandlerVars();
+  ButtonExtension ext;
+  Button2 button = createTestButton();
+  button.setExtension(&ext);
+  g_handler_called = 0;
+
+  button.setDoubleClickHandler([](Button2& b) {
+    g_double_click = true;
+  });
+  button.setMultiClickHandler([](Button2& b) {
+    g_handler_called++;
+    g_clicks_seen = b.getNumberOfClicks();
+  }, 6);
+
+  // has its own handler
+  clickTimes(button, 2);
+  assertTrue(g_double_click);
+  assertEqual(g_handler_called, 0);
+
+  clickTimes(button, 3);
+  assertEqual(g_handler_called, 1);
+  assertEqual(g_clicks_seen, 3);
+
+  clickTimes(button, 6);
+  assertEqual(g_handler_called, 2);
+  assertEqual(g_clicks_seen, 6);
+
+  // above max_clicks
+  clickTimes(button, 7);
+  assertEqual(g_handler_called, 2);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(callbacks, multi_click_handler_sets_auto_max_clicks) {
+  resetHandlerVars();
+  ButtonExtension ext;
+  Button2 button = createTestButton();
+  button.setExtension(&ext);
+  g_clicks_seen = 0;
+
+  button.setMaxClicks(BTN_MAX_CLICKS_AUTO);
+  button.setMultiClickHandler([](Button2& b) {
+    g_clicks_seen = b.getNumberOfClicks();
+  }, 4);
+
+  for (uint8_t i = 0; i < 4; i++) click(button, DEBOUNCE_MS);
+  // reported on the 4th release
+  assertEqual(g_clicks_seen, 4);
+}
+
+/////////////////////////////////////////////////////////////////
+
 test(callbacks, long_click_handler) {
   resetHandlerVars();
   Button2 button = createTestButton();
@@ -218,7 +352,7 @@ test(callbacks, long_click_handler) {
 
   // Long click
   click(button, BTN_LONGCLICK_MS + 50);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   assertTrue(g_long_click);
@@ -308,7 +442,7 @@ test(callbacks, multiple_handlers_on_click) {
 
   // Single click
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   // All handlers should have been called
@@ -321,6 +455,170 @@ test(callbacks, multiple_handlers_on_click) {
 
 /////////////////////////////////////////////////////////////////
 
+test(callbacks, event_handler_receives_all_events) {
+  resetHandlerVars();
+  Button2 button = createTestButton();
+  button.resetPressedState();
+
+  static uint8_t events[BTN_EVENT_COUNT];
+  memset(events, 0, sizeof(events));
+  button.setClickHandler([](Button2& b) { g_click = true; });
+  button.setEventHandler([](Button2& b, buttonEvent ev) {
+    events[ev]++;
+  });
+
+  click(button, DEBOUNCE_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
+  button.loop();
+
+  // specific handler and event handler both fire
+  assertTrue(g_click);
+  assertEqual(events[pressed_event], 1);
+  assertEqual(events[released_event], 1);
+  assertEqual(events[changed_event], 2);
+  assertEqual(events[tap_event], 1);
+  assertEqual(events[click_event], 1);
+  assertEqual(events[double_click_event], 0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(callbacks, event_handler_reports_long_click_detected) {
+  resetHandlerVars();
+  Button2 button = createTestButton();
+  button.resetPressedState();
+
+  // no specific long click detected handler registered
+  button.setEventHandler([](Button2& b, buttonEvent ev) {
+    if (ev == longclick_detected_event) g_long_detected = true;
+    if (ev == long_click_event) g_long_click = true;
+  });
+
+  click(button, BTN_LONGCLICK_MS + 50);
+  testDelay(BTN_DOUBLECLICK_MS);
+  button.loop();
+
+  assertTrue(g_long_detected);
+  assertTrue(g_long_click);
+}
+
+/////////////////////////////////////////////////////////////////
+
+class CountingListener : public Button2Listener {
+ public:
+  uint8_t events[BTN_EVENT_COUNT] = {};
+  void onButtonEvent(Button2&, buttonEvent ev) override {
+    events[ev]++;
+  }
+};
+
+test(callbacks, listeners_receive_events_next_to_event_handler) {
+  resetHandlerVars();
+  Button2 button = createTestButton();
+  button.resetPressedState();
+
+  static uint8_t handled = 0;
+  handled = 0;
+  button.setEventHandler([](Button2& b, buttonEvent ev) {
+    if (ev == click_event) handled++;
+  });
+  CountingListener first, second;
+  Button2ListenerLink first_link, second_link, again;
+  assertTrue(button.addListener(first, first_link));
+  assertTrue(button.addListener(second, second_link));
+  assertFalse(button.addListener(second, again));
+
+  click(button, DEBOUNCE_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
+  button.loop();
+
+  assertEqual(handled, (uint8_t)1);
+  assertEqual(first.events[click_event], (uint8_t)1);
+  assertEqual(second.events[click_event], (uint8_t)1);
+  assertEqual(first.events[changed_event], (uint8_t)2);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(callbacks, listener_detaches_when_destroyed) {
+  resetHandlerVars();
+  Button2 button = createTestButton();
+  button.resetPressedState();
+
+  CountingListener kept;
+  Button2ListenerLink kept_link;
+  button.addListener(kept, kept_link);
+  {
+    CountingListener gone;
+    Button2ListenerLink gone_link;
+    button.addListener(gone, gone_link);
+  }
+  // a listener alone also enables the long click detection
+  click(button, BTN_LONGCLICK_MS + 50);
+  testDelay(BTN_DOUBLECLICK_MS);
+  button.loop();
+  button.removeListener(kept);
+
+  assertEqual(kept.events[longclick_detected_event], (uint8_t)1);
+  assertEqual(kept.events[long_click_event], (uint8_t)1);
+
+  click(button, DEBOUNCE_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
+  button.loop();
+  assertEqual(kept.events[click_event], (uint8_t)0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(callbacks, listener_leaves_other_buttons_alone) {
+  resetHandlerVars();
+  Button2 button = createTestButton();
+  button.resetPressedState();
+  Button2 other;
+  other.setButtonStateFunction(getSimulatedPinState);
+  other.begin(BTN_VIRTUAL_PIN);
+
+  // held past the long click time without handlers: no long click yet
+  pressAndHold(button, BTN_LONGCLICK_MS + 50);
+  clickType alone = button.getType();
+  uint16_t alone_count = button.getLongClickCount();
+  release(button);
+  testDelay(BTN_DOUBLECLICK_MS);
+  button.loop();
+  button.resetPressedState();
+
+  // the same with a listener on another button
+  CountingListener listener;
+  Button2ListenerLink link;
+  other.addListener(listener, link);
+  pressAndHold(button, BTN_LONGCLICK_MS + 50);
+  assertEqual(button.getType(), alone);
+  assertEqual(button.getLongClickCount(), alone_count);
+  release(button);
+  testDelay(BTN_DOUBLECLICK_MS);
+  button.loop();
+
+  assertEqual(alone, clickType::empty);
+  assertEqual(listener.events[longclick_detected_event], (uint8_t)0);
+  assertEqual(listener.events[long_click_event], (uint8_t)0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(callbacks, button_leaves_listener_when_destroyed) {
+  CountingListener listener;
+  Button2ListenerLink link;
+  {
+    Button2 button = createTestButton();
+    assertTrue(button.addListener(listener, link));
+  }
+  // the link is free again
+  Button2 button = createTestButton();
+  assertTrue(button.addListener(listener, link));
+}
+
+/////////////////////////////////////////////////////////////////
+
 test(callbacks, context_in_pressed_handler) {
   resetHandlerVars();
   Button2 button = createTestButton();
@@ -333,7 +631,7 @@ test(callbacks, context_in_pressed_handler) {
   });
 
   press(button);
-  delay(DEBOUNCE_MS);
+  testDelay(DEBOUNCE_MS);
   button.loop();
 
   assertEqual(value, 1);
@@ -373,7 +671,7 @@ test(callbacks, context_in_double_click_handler) {
 
   click(button, DEBOUNCE_MS);
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS + 10);
+  testDelay(BTN_DOUBLECLICK_MS + 10);
   button.loop();
 
   assertEqual(value, 3);
@@ -393,7 +691,7 @@ test(callbacks, context_in_long_click_handler) {
   });
 
   click(button, BTN_LONGCLICK_MS + 10);
-  delay(BTN_DOUBLECLICK_MS + 10);
+  testDelay(BTN_DOUBLECLICK_MS + 10);
   button.loop();
 
   assertEqual(value, 4);
@@ -415,7 +713,7 @@ test(callbacks, handler_gets_correct_button_reference) {
   });
 
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   assertEqual(receivedID, buttonID);
@@ -425,6 +723,7 @@ test(callbacks, handler_gets_correct_button_reference) {
 
 void setup() {
   setup_test_runner();
+  useTestClock();
 
   delay(100);  // Reduced for faster native testing
   Serial.begin(SERIAL_SPEED);
@@ -61,12 +61,12 @@ test(clicks, not_a_click) {
   // According to Button2 logic, presses shorter than debounce_time_ms are ignored
   simulatedPinState = BUTTON_ACTIVE;
   button.loop();
-  delay(BTN_DEBOUNCE_MS - 10);  // Just under debounce time - should not register
+  testDelay(BTN_DEBOUNCE_MS - 10);  // Just under debounce time - should not register
   simulatedPinState = !BUTTON_ACTIVE;
   button.loop(); // Process release - should be ignored due to short duration
   
   // Wait for any remaining processing and timeouts
-  delay(BTN_DOUBLECLICK_MS + 50);
+  testDelay(BTN_DOUBLECLICK_MS + 50);
   button.loop();
   
   // run the tests - should be no press detected since it was too short
@@ -89,7 +89,7 @@ test(clicks, single_click) {
   int time = DEBOUNCE_MS;
   click(button, time);
   // wait out the double click time
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
   int pressedFor = button.wasPressedFor();
 
@@ -125,7 +125,7 @@ test(clicks, long_click) {
   int time = BTN_LONGCLICK_MS + 10;
   click(button, time);
    // wait out the double click time
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
   int pressedFor = button.wasPressedFor();
   // run the tests
@@ -151,7 +151,7 @@ test(clicks, double_click) {
   click(button, time);
   click(button, time);
   // wait out the double click time
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
   // run the tests
   assertTrue(button.wasPressed());
@@ -170,7 +170,7 @@ test(clicks, triple_click) {
   click(button, time);
   click(button, time);
   // wait out the double click time
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
   // run the tests
   assertTrue(button.wasPressed());
@@ -190,7 +190,7 @@ test(clicks, more_than_3_click) {
   click(button, time);
   click(button, time);
 
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
   // run the tests
   assertTrue(button.wasPressed());
@@ -207,7 +207,7 @@ test (clicks, reset) {
   int time = DEBOUNCE_MS;
   click(button, time);
   // wait out the double click time
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
   // run the tests
   assertTrue(button.wasPressed());
@@ -218,6 +218,74 @@ test (clicks, reset) {
   assertEqual(button.getNumberOfClicks(), 0);
 }
 
+/////////////////////////////////////////////////////////////////
+// EARLY RESOLUTION TESTS
+/////////////////////////////////////////////////////////////////
+
+test(early, single_click_reported_on_release) {
+  Button2 button = createTestButton();
+  button.setMaxClicks(1);
+  click(button, DEBOUNCE_MS);
+  // no need to wait for the double click time
+  assertTrue(button.wasPressed());
+  assertEqual(button.getType(), single_click);
+  assertEqual(button.getNumberOfClicks(), 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(early, double_click_reported_on_second_release) {
+  Button2 button = createTestButton();
+  button.setMaxClicks(2);
+  click(button, DEBOUNCE_MS);
+  assertFalse(button.wasPressed());
+  click(button, DEBOUNCE_MS);
+  assertTrue(button.wasPressed());
+  assertEqual(button.getType(), double_click);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(early, long_click_ends_sequence) {
+  Button2 button = createTestButton();
+  button.setMaxClicks(3);
+  click(button, BTN_LONGCLICK_MS + 10);
+  assertTrue(button.wasPressed());
+  assertEqual(button.getType(), long_click);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(early, auto_uses_registered_handlers) {
+  Button2 button = createTestButton();
+  button.setMaxClicks(BTN_MAX_CLICKS_AUTO);
+  assertEqual(button.getMaxClicks(), BTN_MAX_CLICKS_AUTO);
+  button.setClickHandler([](Button2& b) {});
+  click(button, DEBOUNCE_MS);
+  assertEqual(button.getType(), single_click);
+  button.read();
+
+  // with a double click handler a single click has to wait
+  button.setDoubleClickHandler([](Button2& b) {});
+  click(button, DEBOUNCE_MS);
+  assertFalse(button.wasPressed());
+  click(button, DEBOUNCE_MS);
+  assertEqual(button.getType(), double_click);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(early, disabled_by_default) {
+  Button2 button = createTestButton();
+  assertEqual(button.getMaxClicks(), 0);
+  button.setClickHandler([](Button2& b) {});
+  click(button, DEBOUNCE_MS);
+  assertFalse(button.wasPressed());
+  testDelay(BTN_DOUBLECLICK_MS);
+  button.loop();
+  assertTrue(button.wasPressed());
+}
+
 /////////////////////////////////////////////////////////////////
 // DEFAULT VALUES TESTS
 /////////////////////////////////////////////////////////////////
@@ -260,6 +328,7 @@ test(defaults, pin) {
 
 void setup() {
   setup_test_runner();
+  useTestClock();
 
   // setup serial
   delay(100);  // Reduced for faster native testing
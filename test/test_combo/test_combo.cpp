@@ -0,0 +1,318 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Combo tests for Button2 library.
+  Tests chords of several buttons, click suppression and
+  Button2::cancelClicks().
+
+  Created by Lennart Hennigs
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+#include <Button2Combo.h>
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+
+static uint8_t pinB = HIGH;
+static uint8_t pinC = HIGH;
+
+uint8_t getPinB() { return pinB; }
+uint8_t getPinC() { return pinC; }
+
+static int lastChord;
+static int chordCount;
+static int clicksA;
+static int clicksB;
+
+void onChord(uint8_t chord) {
+  lastChord = chord;
+  chordCount++;
+}
+
+Button2 createButton(uint8_t& pin, uint8_t (*f)()) {
+  Button2 button;
+  pin = !BUTTON_ACTIVE;
+  button.setButtonStateFunction(f);
+  button.begin(BUTTON_PIN, BUTTON_MODE, BUTTON_ACTIVE == LOW);
+  return button;
+}
+
+void run(Button2Combo& combo, unsigned long ms) {
+  unsigned long end = testMillis() + ms;
+  while (testMillis() < end) {
+    combo.loop();
+    testDelay(1);
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+// a = simulatedPinState, b = pinB, c = pinC
+
+struct ComboFixture {
+  Button2 a = createTestButton();
+  Button2 b = createButton(pinB, getPinB);
+  Button2 c = createButton(pinC, getPinC);
+  Button2Combo combo;
+  uint16_t AB = 0;
+  uint16_t AC = 0;
+
+  ComboFixture() {
+    lastChord = -1;
+    chordCount = clicksA = clicksB = 0;
+    a.setClickHandler([](Button2& btn) { clicksA++; });
+    b.setClickHandler([](Button2& btn) { clicksB++; });
+    combo.add(a);
+    combo.add(b);
+    combo.add(c);
+    AB = combo.maskOf(a) | combo.maskOf(b);
+    AC = combo.maskOf(a) | combo.maskOf(c);
+  }
+};
+
+enum { AB_CLICK, AC_CLICK, AB_HOLD };
+
+// long enough for every button to pass the debounce time
+#define PRESS_MS  (DEBOUNCE_MS + 20)
+
+/////////////////////////////////////////////////////////////////
+// COMBO TESTS
+/////////////////////////////////////////////////////////////////
+
+test(combo, masks) {
+  ComboFixture f;
+  assertEqual(f.combo.maskOf(f.a), 1);
+  assertEqual(f.combo.maskOf(f.c), 4);
+  Button2 other;
+  assertEqual(f.combo.maskOf(other), 0);
+  assertFalse(f.combo.addChord(0, onChord));
+
+  simulatedPinState = BUTTON_ACTIVE;
+  pinC = BUTTON_ACTIVE;
+  run(f.combo, PRESS_MS);
+  assertEqual(f.combo.getPressedMask(), f.AC);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(combo, click_chord_fires_on_release) {
+  ComboFixture f;
+  f.combo.addChord(f.AB, onChord);
+  f.combo.addChord(f.AC, onChord);
+
+  simulatedPinState = BUTTON_ACTIVE;
+  run(f.combo, 30);
+  pinC = BUTTON_ACTIVE;
+  run(f.combo, PRESS_MS);
+  assertEqual(chordCount, 0);
+  simulatedPinState = !BUTTON_ACTIVE;
+  run(f.combo, 10);
+  // C is still down
+  assertEqual(chordCount, 0);
+  pinC = !BUTTON_ACTIVE;
+  run(f.combo, 10);
+  assertEqual(lastChord, AC_CLICK);
+  assertEqual(chordCount, 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(combo, hold_chord_fires_while_held) {
+  ComboFixture f;
+  f.combo.addChord(f.AB, onChord);
+  f.combo.addChord(f.AC, onChord);
+  f.combo.addChord(f.AB, onChord, 100);
+
+  simulatedPinState = BUTTON_ACTIVE;
+  pinB = BUTTON_ACTIVE;
+  run(f.combo, 60);
+  assertEqual(chordCount, 0);
+  run(f.combo, PRESS_MS + 60);
+  assertEqual(lastChord, AB_HOLD);
+  run(f.combo, 150);
+  // once per sequence, and no click chord on release
+  simulatedPinState = pinB = !BUTTON_ACTIVE;
+  run(f.combo, 10);
+  assertEqual(chordCount, 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(combo, late_press_spoils_chord) {
+  ComboFixture f;
+  f.combo.addChord(f.AB, onChord);
+  f.combo.setChordWindow(50);
+
+  simulatedPinState = BUTTON_ACTIVE;
+  run(f.combo, 100);
+  pinB = BUTTON_ACTIVE;
+  run(f.combo, PRESS_MS);
+  simulatedPinState = pinB = !BUTTON_ACTIVE;
+  run(f.combo, 10);
+  assertEqual(chordCount, 0);
+
+  // the next sequence starts fresh
+  simulatedPinState = pinB = BUTTON_ACTIVE;
+  run(f.combo, PRESS_MS);
+  simulatedPinState = pinB = !BUTTON_ACTIVE;
+  run(f.combo, 10);
+  assertEqual(lastChord, AB_CLICK);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(combo, clicks_suppressed) {
+  ComboFixture f;
+  f.combo.addChord(f.AB, onChord);
+
+  // by default the buttons click as well
+  simulatedPinState = pinB = BUTTON_ACTIVE;
+  run(f.combo, PRESS_MS);
+  simulatedPinState = pinB = !BUTTON_ACTIVE;
+  run(f.combo, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(chordCount, 1);
+  assertEqual(clicksA, 1);
+  assertEqual(clicksB, 1);
+
+  f.combo.setSuppressClicks(true);
+  simulatedPinState = pinB = BUTTON_ACTIVE;
+  run(f.combo, PRESS_MS);
+  simulatedPinState = pinB = !BUTTON_ACTIVE;
+  run(f.combo, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(chordCount, 2);
+  assertEqual(clicksA, 1);
+  assertEqual(clicksB, 1);
+
+  // a single button still clicks
+  simulatedPinState = BUTTON_ACTIVE;
+  run(f.combo, PRESS_MS);
+  simulatedPinState = !BUTTON_ACTIVE;
+  run(f.combo, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(clicksA, 2);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(combo, event_handlers_stay_free) {
+  static int events;
+  events = 0;
+  ComboFixture f;
+  f.a.setEventHandler([](Button2& btn, buttonEvent ev) {
+    if (ev == pressed_event) events++;
+  });
+  f.combo.addChord(f.AB, onChord);
+
+  simulatedPinState = BUTTON_ACTIVE;
+  pinB = BUTTON_ACTIVE;
+  run(f.combo, PRESS_MS);
+  simulatedPinState = !BUTTON_ACTIVE;
+  pinB = !BUTTON_ACTIVE;
+  run(f.combo, 10);
+  assertEqual(lastChord, AB_CLICK);
+  assertEqual(events, 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(combo, throttled_buttons_keep_chords) {
+  ButtonExtension extA, extB;
+  ComboFixture f;
+  f.a.setExtension(&extA);
+  f.b.setExtension(&extB);
+  f.a.setRateLimit(1, 10000);
+  f.b.setRateLimit(1, 10000);
+  f.combo.addChord(f.AB, onChord);
+
+  // the rate limits must not swallow the edges the chords are made of
+  for (uint8_t i = 0; i < 3; i++) {
+    simulatedPinState = BUTTON_ACTIVE;
+    pinB = BUTTON_ACTIVE;
+    run(f.combo, PRESS_MS);
+    assertEqual(f.combo.getPressedMask(), f.AB);
+    simulatedPinState = !BUTTON_ACTIVE;
+    pinB = !BUTTON_ACTIVE;
+    run(f.combo, PRESS_MS);
+    assertEqual(f.combo.getPressedMask(), 0);
+  }
+  assertEqual(chordCount, 3);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(combo, cancel_clicks) {
+  static int longClicks;
+  longClicks = 0;
+  Button2 button = createTestButton();
+  button.setLongClickDetectedHandler([](Button2& btn) { longClicks++; });
+  button.setLongClickHandler([](Button2& btn) { longClicks++; });
+
+  pressAndHold(button, DEBOUNCE_MS);
+  button.cancelClicks();
+  pressAndHold(button, BTN_LONGCLICK_MS + 10);
+  release(button);
+  testDelay(BTN_DOUBLECLICK_MS + 10);
+  button.loop();
+  assertEqual(longClicks, 0);
+  assertEqual(button.getNumberOfClicks(), 0);
+
+  // the next press is a normal long click again
+  pressAndHold(button, BTN_LONGCLICK_MS + 10);
+  release(button);
+  testDelay(BTN_DOUBLECLICK_MS + 10);
+  button.loop();
+  assertEqual(longClicks, 2);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(combo, cancel_clicks_after_long_click_detected) {
+  Button2 button = createTestButton();
+  button.setLongClickDetectedHandler([](Button2& btn) {});
+  pressAndHold(button, BTN_LONGCLICK_MS + 10);
+  assertEqual(button.getSnapshot().longclick_count, 1);
+
+  // the long click is dropped from the published state as well
+  button.cancelClicks();
+  assertEqual(button.getSnapshot().longclick_count, 0);
+  assertEqual(button.getLongClickCount(), 0);
+  release(button);
+  testDelay(BTN_DOUBLECLICK_MS + 10);
+  button.loop();
+  assertEqual(button.getLongClickCount(), 0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+  useTestClock();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Combo Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
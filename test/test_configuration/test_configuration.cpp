@@ -115,7 +115,7 @@ test(settings, resetPressedState) {
   int time = DEBOUNCE_MS;
   click(button, time);
   // wait out the double click time
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
   // run the tests
   assertTrue(button.wasPressed());
@@ -184,7 +184,7 @@ test(settings, context_in_callback) {
   });
 
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS + 10);
+  testDelay(BTN_DOUBLECLICK_MS + 10);
   button.loop();
 
   assertEqual(ctx.result, 99);
@@ -202,6 +202,57 @@ test(settings, context_survives_reset) {
 
 /////////////////////////////////////////////////////////////////
 
+test(settings, reset_drops_caller_owned_state) {
+  static int clicks;
+  clicks = 0;
+  ButtonExtension ext;
+  ButtonBounceStats stats;
+  ButtonClickCadence cadence;
+  Button2 button = createTestButton();
+  button.setExtension(&ext);
+  button.setRateLimit(1, 60000);
+  button.setBounceStats(&stats);
+  button.setAdaptiveDoubleClick(&cadence);
+  button.reset();
+  button.begin(BUTTON_PIN, BUTTON_MODE, BUTTON_ACTIVE == LOW);
+  assertEqual(button.getExtension(), (ButtonExtension*)nullptr);
+
+  button.setClickHandler([](Button2& b) { clicks++; });
+  button.setDoubleClickTime(0);
+  for (uint8_t i = 0; i < 3; i++) {
+    click(button, DEBOUNCE_MS);
+    testDelay(10);
+    button.loop();
+  }
+  // neither throttled nor counted
+  assertEqual(clicks, 3);
+  assertEqual(button.getThrottledEvents(), 0);
+  assertEqual(stats.trains, 0);
+  assertEqual(cadence.samples, 0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(settings, optional_features_need_extension) {
+  ButtonBounceStats stats;
+  ButtonClickCadence cadence;
+  Button2 button = createTestButton();
+  assertFalse(button.setRateLimit(1, 100));
+  assertFalse(button.setLongClickCoalesceTime(100));
+  assertFalse(button.setMultiClickHandler([](Button2& b) {}, 5));
+  assertFalse(button.setBounceStats(&stats));
+  assertFalse(button.setAdaptiveDoubleClick(&cadence));
+  assertEqual(button.getLongClickCoalesceTime(), 0U);
+
+  ButtonExtension ext;
+  button.setExtension(&ext);
+  assertTrue(button.setRateLimit(1, 100));
+  assertTrue(button.setLongClickCoalesceTime(100));
+  assertEqual(button.getLongClickCoalesceTime(), 100U);
+}
+
+/////////////////////////////////////////////////////////////////
+
 test(settings, context_survives_resetPressedState) {
   Button2 button = createTestButton();
   int value = 7;
@@ -247,7 +298,7 @@ test(settings, set_pressed_handler) {
   release(button);
   button.resetPressedState();
   press(button);
-  delay(DEBOUNCE_MS);
+  testDelay(DEBOUNCE_MS);
   button.loop();
   assertEqual(testVal, 101);
   
@@ -265,6 +316,7 @@ test(settings, set_pressed_handler) {
 
 void setup() {
   setup_test_runner();
+  useTestClock();
 
   // setup serial
   delay(100);  // Reduced for faster native testing
@@ -0,0 +1,235 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Coroutine tests for Button2 library.
+  Tests co_await on button events, anyOf(), sleepFor() and the
+  single-threaded executor.
+
+  Created by Lennart Hennigs
+  Requires a C++20 build (-std=gnu++2a), see the test_coro environment
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+#include <Button2Coro.h>
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+
+#ifdef BUTTON2_HAS_CORO
+
+static uint8_t otherPinState = HIGH;
+
+uint8_t getOtherPinState() {
+  return otherPinState;
+}
+
+// run the executor like a sketch's loop() would
+void runFor(Button2Executor& exec, unsigned long ms) {
+  unsigned long end = testMillis() + ms;
+  while (testMillis() < end) {
+    exec.loop();
+    testDelay(1);
+  }
+}
+
+// press/release `pin` while the executor runs
+void clickWith(Button2Executor& exec, uint8_t& pin, unsigned long duration) {
+  pin = BUTTON_ACTIVE;
+  runFor(exec, duration);
+  pin = !BUTTON_ACTIVE;
+  runFor(exec, 5);
+}
+
+/////////////////////////////////////////////////////////////////
+
+static int step;
+
+Button2Task clickFlow(Button2& btn) {
+  step = 1;
+  co_await btn.nextClick();
+  step = 2;
+  buttonEvent ev = co_await btn.on(pressed_event);
+  step = (ev == pressed_event) ? 3 : -1;
+}
+
+/////////////////////////////////////////////////////////////////
+// COROUTINE TESTS
+/////////////////////////////////////////////////////////////////
+
+test(coro, task_runs_until_first_await) {
+  Button2 button = createTestButton();
+  Button2Executor exec;
+  exec.add(button);
+  step = 0;
+  assertTrue(exec.spawn(clickFlow(button)));
+  assertEqual(step, 0);
+  exec.loop();
+  assertEqual(step, 1);
+  runFor(exec, 20);
+  assertEqual(step, 1);
+  assertEqual(exec.getTaskCount(), 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(coro, resumed_by_events_in_order) {
+  Button2 button = createTestButton();
+  Button2Executor exec;
+  exec.add(button);
+  step = 0;
+  exec.spawn(clickFlow(button));
+
+  clickWith(exec, simulatedPinState, DEBOUNCE_MS);
+  assertEqual(step, 1);
+  runFor(exec, BTN_DOUBLECLICK_MS);
+  assertEqual(step, 2);
+
+  simulatedPinState = BUTTON_ACTIVE;
+  runFor(exec, DEBOUNCE_MS);
+  assertEqual(step, 3);
+  // finished tasks are freed
+  assertEqual(exec.getTaskCount(), 0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+static int8_t anyResult;
+
+Button2Task anyFlow(Button2& a, Button2& b) {
+  anyResult = co_await anyOf(a.longClick(), b.nextClick());
+}
+
+test(coro, any_of_returns_matching_index) {
+  Button2 first = createTestButton();
+  Button2 second;
+  otherPinState = !BUTTON_ACTIVE;
+  second.setButtonStateFunction(getOtherPinState);
+  second.begin(BUTTON_PIN, BUTTON_MODE, BUTTON_ACTIVE == LOW);
+  Button2Executor exec;
+  exec.add(first);
+  exec.add(second);
+
+  anyResult = -1;
+  exec.spawn(anyFlow(first, second));
+  // a single click on the first button does not match
+  clickWith(exec, simulatedPinState, DEBOUNCE_MS);
+  runFor(exec, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(anyResult, -1);
+
+  clickWith(exec, otherPinState, DEBOUNCE_MS);
+  runFor(exec, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(anyResult, 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+static unsigned long woke[2];
+
+Button2Task sleeper(uint8_t i, unsigned long ms) {
+  co_await sleepFor(ms);
+  woke[i] = testMillis();
+}
+
+test(coro, concurrent_sleeping_tasks) {
+  // the executor sleeps on the clock of its first button
+  Button2 button = createTestButton();
+  Button2Executor exec;
+  exec.add(button);
+  woke[0] = woke[1] = 0;
+  unsigned long start = testMillis();
+  exec.spawn(sleeper(0, 60));
+  exec.spawn(sleeper(1, 20));
+  exec.loop();
+  unsigned long next = exec.timeToNextDeadline();
+  assertTrue(next <= 20);
+  assertTrue(next > 0);
+
+  runFor(exec, 100);
+  assertTrue(woke[1] - start >= 20);
+  assertTrue(woke[0] - start >= 60);
+  assertTrue(woke[1] < woke[0]);
+  assertEqual(exec.getTaskCount(), 0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(coro, handlers_still_called) {
+  static int clicks, events;
+  clicks = 0;
+  events = 0;
+  Button2 button = createTestButton();
+  button.setClickHandler([](Button2& b) { clicks++; });
+  button.setEventHandler([](Button2& b, buttonEvent ev) {
+    if (ev == click_event) events++;
+  });
+  Button2Executor exec;
+  exec.add(button);
+  step = 0;
+  exec.spawn(clickFlow(button));
+  clickWith(exec, simulatedPinState, DEBOUNCE_MS);
+  runFor(exec, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(clicks, 1);
+  assertEqual(events, 1);
+  assertEqual(step, 2);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(coro, sleeps_on_button_clock) {
+  auto clock = Button2::getTimeFunction();
+  Button2::setTimeFunction(getVirtualTime);
+  Button2 button = createTestButton();
+  Button2Executor exec;
+  exec.add(button);
+  woke[0] = 0;
+  exec.spawn(sleeper(0, 60000UL));
+  exec.loop();
+  assertEqual(exec.timeToNextDeadline(), 60000UL);
+
+  // a minute on the button's clock, no time in real life
+  virtualTime += 59999UL;
+  exec.loop();
+  assertEqual(exec.getTaskCount(), 1);
+  virtualTime += 1;
+  exec.loop();
+  assertEqual(exec.getTaskCount(), 0);
+  Button2::setTimeFunction(clock);
+}
+
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+  useTestClock();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Coroutine Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,201 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Debounce tests for Button2 library.
+  Tests the debounce modes (stable, lockout, integrator) and
+  separate press/release windows.
+
+  Created by Lennart Hennigs
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+
+static int pressedCount;
+static int releasedCount;
+static int clickCount;
+
+Button2 createDebounceButton(debounceMode mode) {
+  Button2 button = createTestButton();
+  pressedCount = releasedCount = clickCount = 0;
+  button.setPressedHandler([](Button2& btn) { pressedCount++; });
+  button.setReleasedHandler([](Button2& btn) { releasedCount++; });
+  button.setClickHandler([](Button2& btn) { clickCount++; });
+  button.setDebounceMode(mode);
+  return button;
+}
+
+// set the input and keep looping for `ms`
+void sample(Button2& button, uint8_t level, unsigned long ms) {
+  simulatedPinState = level;
+  button.loop();
+  unsigned long end = testMillis() + ms;
+  while (testMillis() < end) {
+    testDelay(1);
+    button.loop();
+  }
+}
+
+#define PRESSED   BUTTON_ACTIVE
+#define RELEASED  !BUTTON_ACTIVE
+
+/////////////////////////////////////////////////////////////////
+// DEBOUNCE TESTS
+/////////////////////////////////////////////////////////////////
+
+test(debounce, stable_is_default) {
+  Button2 button = createTestButton();
+  assertEqual(button.getDebounceMode(), debounce_stable);
+  assertEqual(button.getReleaseDebounceTime(), 0U);
+  button.setDebounceTime(20, 5);
+  assertEqual(button.getDebounceTime(), 20U);
+  assertEqual(button.getReleaseDebounceTime(), 5U);
+
+  button = createDebounceButton(debounce_stable);
+  // the press is reported after the debounce time only
+  sample(button, PRESSED, BTN_DEBOUNCE_MS / 2);
+  assertEqual(pressedCount, 0);
+  sample(button, PRESSED, BTN_DEBOUNCE_MS);
+  assertEqual(pressedCount, 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(debounce, stable_release_window) {
+  Button2 button = createDebounceButton(debounce_stable);
+  button.setDebounceTime(BTN_DEBOUNCE_MS, 20);
+
+  sample(button, PRESSED, DEBOUNCE_MS);
+  // a release shorter than the window is a bounce
+  sample(button, RELEASED, 5);
+  sample(button, PRESSED, 10);
+  assertEqual(releasedCount, 0);
+  assertTrue(button.isPressed());
+
+  sample(button, RELEASED, 30);
+  assertEqual(releasedCount, 1);
+  assertEqual(pressedCount, 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(debounce, lockout_reacts_to_first_edge) {
+  Button2 button = createDebounceButton(debounce_lockout);
+
+  simulatedPinState = PRESSED;
+  button.loop();
+  assertEqual(pressedCount, 1);
+
+  // bouncing within the window is ignored
+  sample(button, RELEASED, 2);
+  sample(button, PRESSED, 2);
+  sample(button, RELEASED, 2);
+  assertEqual(releasedCount, 0);
+  assertTrue(button.isPressed());
+  // the release edge is still pending once the window has passed
+  sample(button, RELEASED, BTN_DEBOUNCE_MS);
+  assertEqual(releasedCount, 1);
+  assertEqual(pressedCount, 1);
+
+  sample(button, RELEASED, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(clickCount, 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(debounce, lockout_release_window) {
+  Button2 button = createDebounceButton(debounce_lockout);
+  button.setDebounceTime(10, BTN_DEBOUNCE_MS);
+
+  sample(button, PRESSED, 15);
+  sample(button, RELEASED, 1);
+  assertEqual(releasedCount, 1);
+  // a bounce after the release must not start a new press
+  sample(button, PRESSED, 5);
+  sample(button, RELEASED, 5);
+  assertEqual(pressedCount, 1);
+  // past the release window presses count again
+  sample(button, RELEASED, BTN_DEBOUNCE_MS);
+  sample(button, PRESSED, 1);
+  assertEqual(pressedCount, 2);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(debounce, integrator_filters_noise) {
+  Button2 button = createDebounceButton(debounce_integrator);
+  button.setDebounceTime(20);
+
+  // short glitches drain again
+  for (uint8_t i = 0; i < 5; i++) {
+    sample(button, PRESSED, 3);
+    sample(button, RELEASED, 10);
+  }
+  assertEqual(pressedCount, 0);
+
+  // a noisy press still adds up
+  for (uint8_t i = 0; i < 10 && pressedCount == 0; i++) {
+    sample(button, PRESSED, 6);
+    sample(button, RELEASED, 2);
+  }
+  assertEqual(pressedCount, 1);
+  sample(button, PRESSED, 20);
+  sample(button, RELEASED, 10);
+  assertEqual(releasedCount, 0);
+  sample(button, RELEASED, 20);
+  assertEqual(releasedCount, 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(debounce, deadline_for_pending_edge) {
+  Button2 button = createDebounceButton(debounce_lockout);
+  sample(button, PRESSED, 5);
+  simulatedPinState = RELEASED;
+  button.loop();
+  assertTrue(button.isPressed());
+  unsigned long next = button.timeToNextDeadline();
+  assertTrue(next > 0);
+  assertTrue(next <= BTN_DEBOUNCE_MS);
+
+  sample(button, RELEASED, BTN_DEBOUNCE_MS);
+  assertFalse(button.isPressed());
+}
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+  useTestClock();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Debounce Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
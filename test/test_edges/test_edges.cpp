@@ -0,0 +1,204 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Edge replay tests for Button2 library.
+  Tests Button2EdgeQueue and Button2::feed(): edges captured with
+  their times are classified correctly after loop() was blocked.
+
+  Created by Lennart Hennigs
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+#include <Button2Edges.h>
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+
+static int clicks;
+static int doubleClicks;
+static int longDetected;
+
+Button2 createEdgeButton() {
+  useTestClock(1000);
+  Button2 button = createTestButton();
+  clicks = doubleClicks = longDetected = 0;
+  button.setClickHandler([](Button2& btn) { clicks++; });
+  button.setDoubleClickHandler([](Button2& btn) { doubleClicks++; });
+  button.setLongClickDetectedHandler([](Button2& btn) { longDetected++; });
+  return button;
+}
+
+#define PRESSED   BUTTON_ACTIVE
+#define RELEASED  !BUTTON_ACTIVE
+
+// the main loop is blocked for this long
+#define STALL_MS  (BTN_DOUBLECLICK_MS * 3)
+
+/////////////////////////////////////////////////////////////////
+// EDGE TESTS
+/////////////////////////////////////////////////////////////////
+
+test(edges, stall_keeps_clicks_apart) {
+  Button2 button = createEdgeButton();
+  Button2EdgeQueue edges;
+  edges.begin(button);
+
+  // two clicks, further apart than the double click window
+  edges.push(PRESSED, 1000);
+  edges.push(RELEASED, 1100);
+  edges.push(PRESSED, 1500);
+  edges.push(RELEASED, 1600);
+  assertEqual(edges.available(), 4);
+  virtualTime += STALL_MS;
+  edges.loop();
+  assertEqual(edges.available(), 0);
+  assertEqual(clicks, 2);
+  assertEqual(doubleClicks, 0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(edges, stall_keeps_double_click) {
+  Button2 button = createEdgeButton();
+  Button2EdgeQueue edges;
+  edges.begin(button);
+
+  edges.push(PRESSED, 1000);
+  edges.push(RELEASED, 1080);
+  edges.push(PRESSED, 1160);
+  edges.push(RELEASED, 1240);
+  virtualTime += STALL_MS;
+  edges.loop();
+  assertEqual(doubleClicks, 1);
+  assertEqual(clicks, 0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(edges, retriggered_long_clicks_counted) {
+  Button2 button = createEdgeButton();
+  button.setLongClickDetectedRetriggerable(true);
+  Button2EdgeQueue edges;
+  edges.begin(button);
+
+  edges.push(PRESSED, 1000);
+  edges.push(RELEASED, 1000 + 5 * BTN_LONGCLICK_MS + 10);
+  virtualTime += STALL_MS + 5 * BTN_LONGCLICK_MS;
+  edges.loop();
+  assertEqual(longDetected, 5);
+  assertEqual(button.read(), long_click);
+  assertEqual(button.wasPressedFor(), 5 * BTN_LONGCLICK_MS + 10);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(edges, edge_newer_than_clock) {
+  Button2 button = createEdgeButton();
+  Button2EdgeQueue edges;
+  edges.begin(button);
+
+  // pushed by the ISR after loop() has read the clock
+  edges.push(PRESSED, virtualTime + 5);
+  edges.loop();
+  virtualTime += 100;
+  edges.loop();
+  assertTrue(button.isPressed());
+  edges.push(RELEASED, virtualTime);
+  virtualTime += STALL_MS;
+  edges.loop();
+  assertEqual(clicks, 1);
+  assertEqual(button.wasPressedFor(), 95U);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(edges, full_queue_drops_edges) {
+  Button2 button = createEdgeButton();
+  Button2EdgeQueue edges;
+  edges.begin(button);
+
+  for (uint8_t i = 0; i < BUTTON2_EDGE_QUEUE_SIZE + 4; i++) {
+    edges.push(i % 2 ? RELEASED : PRESSED, 1000 + i * 10);
+  }
+  assertEqual(edges.available(), BUTTON2_EDGE_QUEUE_SIZE - 1);
+  assertEqual(edges.getDroppedEdges(), 5);
+  edges.loop();
+  assertEqual(edges.available(), 0);
+  assertTrue(edges.push(PRESSED, virtualTime));
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(edges, full_queue_resyncs_with_pin) {
+  Button2 button = createEdgeButton();
+  Button2EdgeQueue edges;
+  edges.begin(button);
+
+  // the queue ends on a press, the final release is dropped
+  for (uint8_t i = 0; i < BUTTON2_EDGE_QUEUE_SIZE; i++) {
+    edges.push(i % 2 ? RELEASED : PRESSED, 1000 + (i / 2) * 500 + (i % 2) * 100);
+  }
+  assertEqual(edges.getDroppedEdges(), 1);
+  simulatedPinState = RELEASED;
+  virtualTime += STALL_MS + BUTTON2_EDGE_QUEUE_SIZE * 250;
+  edges.loop();
+  assertFalse(button.isPressed());
+  virtualTime += STALL_MS;
+  edges.loop();
+  // the last press lasts until the pin was read
+  assertEqual(clicks, BUTTON2_EDGE_QUEUE_SIZE / 2 - 1);
+  assertEqual(button.read(), long_click);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(edges, feed_catches_up_before_edge) {
+  Button2 button = createEdgeButton();
+
+  // samples of a backend, processed late
+  virtualTime += STALL_MS;
+  button.feed(PRESSED, 1000);
+  button.feed(RELEASED, 1100);
+  // the window of the first click has passed before this press
+  button.feed(PRESSED, 1100 + BTN_DOUBLECLICK_MS);
+  assertEqual(clicks, 1);
+  button.feed(RELEASED, 1200 + BTN_DOUBLECLICK_MS);
+  button.advanceTo(virtualTime);
+  assertEqual(clicks, 2);
+  assertEqual(doubleClicks, 0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Edge Replay Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,274 @@
+/////////////////////////////////////////////////////////////////
+/*
+  File-descriptor source tests for Button2 library.
+  Tests timeToNextDeadline() and Button2FdSource fed through a pipe.
+
+  Created by Lennart Hennigs
+  The fd source tests run on the native (EpoxyDuino) environments
+  on Linux only
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+#include <Button2Fd.h>
+
+#ifdef BUTTON2_HAS_FD_SOURCE
+#include <unistd.h>
+#ifdef BUTTON2_FD_HAS_GPIO
+#include <string.h>
+#include <time.h>
+#endif
+#endif
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+// DEADLINE TESTS
+/////////////////////////////////////////////////////////////////
+
+test(deadline, idle_button_has_none) {
+  Button2 button = createTestButton();
+  button.loop();
+  assertTrue(button.timeToNextDeadline() == BTN_NO_DEADLINE);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(deadline, debounce_after_press) {
+  Button2 button = createTestButton();
+  simulatedPinState = BUTTON_ACTIVE;
+  button.loop();
+  unsigned long t = button.timeToNextDeadline();
+  assertTrue(t <= BTN_DEBOUNCE_MS);
+  assertTrue(t + 5 >= BTN_DEBOUNCE_MS);
+
+  // validated, no long click handler: wait for the release
+  delay(DEBOUNCE_MS);
+  button.loop();
+  assertTrue(button.timeToNextDeadline() == BTN_NO_DEADLINE);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(deadline, long_click_when_handler_set) {
+  Button2 button = createTestButton();
+  button.setLongClickDetectedHandler([](Button2& b) {});
+  simulatedPinState = BUTTON_ACTIVE;
+  button.loop();
+  delay(DEBOUNCE_MS);
+  button.loop();
+  unsigned long t = button.timeToNextDeadline();
+  assertTrue(t <= BTN_LONGCLICK_MS - BTN_DEBOUNCE_MS);
+  assertTrue(t + 20 >= BTN_LONGCLICK_MS - DEBOUNCE_MS);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(deadline, click_window_after_release) {
+  Button2 button = createTestButton();
+  click(button, DEBOUNCE_MS);
+  unsigned long t = button.timeToNextDeadline();
+  assertTrue(t > 0);
+  assertTrue(t <= BTN_DOUBLECLICK_MS + 1);
+
+  delay(t);
+  assertEqual(button.timeToNextDeadline(), 0UL);
+  button.loop();
+  assertTrue(button.wasPressed());
+  assertTrue(button.timeToNextDeadline() == BTN_NO_DEADLINE);
+}
+
+/////////////////////////////////////////////////////////////////
+
+#ifdef BUTTON2_HAS_FD_SOURCE
+
+struct FdFixture {
+  int fds[2];
+  Button2 button;
+  Button2FdSource source;
+
+  FdFixture() {
+    pipe(fds);
+    source.add(button, fds[0]);
+    button.begin(BTN_VIRTUAL_PIN, INPUT, true);
+  }
+  ~FdFixture() {
+    close(fds[0]);
+    if (fds[1] >= 0) close(fds[1]);
+  }
+  void send(const char* levels) {
+    write(fds[1], levels, strlen(levels));
+  }
+};
+
+/////////////////////////////////////////////////////////////////
+// FD SOURCE TESTS
+/////////////////////////////////////////////////////////////////
+
+test(fdsource, waits_until_max_wait_without_edges) {
+  FdFixture f;
+  unsigned long start = millis();
+  assertEqual(f.source.loop(30), 0);
+  assertTrue(millis() - start >= 30);
+  assertEqual(f.source.getWakeupCount(), (uint32_t)1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(fdsource, click_with_few_wakeups) {
+  FdFixture f;
+  static int clicks;
+  clicks = 0;
+  f.button.setClickHandler([](Button2& b) { clicks++; });
+
+  // press (active low), wake at the debounce deadline
+  unsigned long start = millis();
+  f.send("0");
+  assertEqual(f.source.loop(1000), 1);
+  assertTrue(f.button.isPressed());
+  f.source.loop(1000);
+  delay(10);
+  f.send("1\n");
+  assertEqual(f.source.loop(1000), 1);
+
+  // sleeps until the double click window (counted from the press) ends
+  while (clicks == 0 && millis() - start < 1000) f.source.loop(1000);
+  assertEqual(clicks, 1);
+  assertTrue(millis() - start > BTN_DOUBLECLICK_MS);
+  assertTrue(millis() - start < BTN_DOUBLECLICK_MS + 20);
+  assertTrue(f.source.getWakeupCount() <= 6);
+  assertEqual(f.source.getEdgeCount(), (uint32_t)2);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(fdsource, long_click_detected_on_time) {
+  FdFixture f;
+  static unsigned long detected;
+  detected = 0;
+  f.button.setLongClickDetectedHandler([](Button2& b) { detected = millis(); });
+
+  unsigned long start = millis();
+  f.send("0");
+  while (detected == 0 && millis() - start < 1000) f.source.loop(1000);
+  assertTrue(detected - start >= BTN_LONGCLICK_MS);
+  assertTrue(detected - start < BTN_LONGCLICK_MS + 20);
+  // initial press, debounce, long click
+  assertTrue(f.source.getWakeupCount() <= 4);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(fdsource, bounce_in_single_read_is_filtered) {
+  FdFixture f;
+  static int pressed;
+  pressed = 0;
+  f.button.setPressedHandler([](Button2& b) { pressed++; });
+
+  f.send("01010");
+  assertEqual(f.source.loop(1000), 5);
+  delay(DEBOUNCE_MS);
+  f.source.loop(0);
+  assertEqual(pressed, 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(fdsource, closed_writer_stops_polling) {
+  FdFixture f;
+  close(f.fds[1]);
+  f.fds[1] = -1;
+  assertEqual(f.source.loop(1000), 0);
+  // no fd and no deadline left: returns immediately
+  unsigned long start = millis();
+  assertEqual(f.source.loop(), 0);
+  assertTrue(millis() - start < 10);
+}
+
+
+/////////////////////////////////////////////////////////////////
+
+#ifdef BUTTON2_FD_HAS_GPIO
+
+// line events written to a pipe instead of a GPIO line request
+struct GpioFdSource : public Button2FdSource {
+  bool addPipe(Button2 &btn, int fd) {
+    return _add(btn, fd, gpio_line, HIGH);
+  }
+};
+
+uint64_t monotonicNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void sendLineEvent(int fd, uint32_t id, uint64_t timestamp_ns) {
+  struct gpio_v2_line_event event;
+  memset(&event, 0, sizeof(event));
+  event.id = id;
+  event.timestamp_ns = timestamp_ns;
+  write(fd, &event, sizeof(event));
+}
+
+test(fdsource, gpio_edges_use_kernel_timestamps) {
+  int fds[2];
+  pipe(fds);
+  Button2 button;
+  GpioFdSource source;
+  source.addPipe(button, fds[0]);
+  button.begin(BTN_VIRTUAL_PIN, INPUT, true);
+  delay(BTN_DOUBLECLICK_MS + 300);
+
+  // a click that was queued while nobody read the fd, the double
+  // click time is over by now
+  uint64_t now = monotonicNs();
+  uint64_t press = now - (BTN_DOUBLECLICK_MS + 200) * 1000000ULL;
+  sendLineEvent(fds[1], GPIO_V2_LINE_EVENT_FALLING_EDGE, press);
+  sendLineEvent(fds[1], GPIO_V2_LINE_EVENT_RISING_EDGE, press + 100000000ULL);
+  assertEqual(source.loop(0), 2);
+  close(fds[0]);
+  close(fds[1]);
+
+  // the press lasted 100ms
+  assertTrue(button.wasPressed());
+  assertTrue(button.wasPressedFor() >= 95);
+  assertTrue(button.wasPressedFor() <= 105);
+}
+
+#endif
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 File Descriptor Source Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,259 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Gesture tests for Button2 library.
+  Tests the pattern compiler (DFA table) and the recognizer.
+
+  Created by Lennart Hennigs
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+#include <Button2Gesture.h>
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+
+enum { CLICK, DOUBLE, CLICK_HOLD, LONG_SHORT_LONG, SOS };
+
+static constexpr const char* patterns[] = { ".", "..", "._", "-.-", "...---..." };
+static BUTTON2_GESTURE_CONSTEXPR Button2GestureTable<20> table(patterns);
+static BUTTON2_GESTURE_CONSTEXPR Button2GestureTable<20> table_P PROGMEM(patterns);
+
+#if __cplusplus >= 201402L
+// built by the compiler
+static_assert(table.valid, "gesture table must compile");
+static_assert(table.states == 14, "shared prefixes share states");
+#endif
+
+static int lastGesture;
+static int gestureCount;
+
+void onGesture(Button2& btn, uint8_t gesture) {
+  lastGesture = gesture;
+  gestureCount++;
+}
+
+/////////////////////////////////////////////////////////////////
+
+Button2 createGestureButton() {
+  Button2 button = createTestButton();
+  lastGesture = -1;
+  gestureCount = 0;
+  return button;
+}
+
+void run(Button2GestureRecognizer& g, unsigned long ms) {
+  unsigned long end = testMillis() + ms;
+  while (testMillis() < end) {
+    g.loop();
+    testDelay(1);
+  }
+}
+
+void pressFor(Button2GestureRecognizer& g, unsigned long ms) {
+  simulatedPinState = BUTTON_ACTIVE;
+  run(g, ms);
+  simulatedPinState = !BUTTON_ACTIVE;
+  run(g, 20);
+}
+
+#define SHORT_MS  (DEBOUNCE_MS + 10)
+#define LONG_MS   (BTN_LONGCLICK_MS + 30)
+
+/////////////////////////////////////////////////////////////////
+// TABLE TESTS
+/////////////////////////////////////////////////////////////////
+
+test(gesture_table, builds_trie) {
+  assertTrue(table.valid);
+  // root + "." ".." "._" + "-" "-." "-.-" + "..." "...-" ... "...---..."
+  assertEqual(table.states, 14);
+  uint8_t s = table.next[0][gesture_short];
+  assertEqual(table.accept[s], CLICK);
+  assertEqual(table.accept[table.next[s][gesture_hold]], CLICK_HOLD);
+  assertEqual(table.accept[table.next[0][gesture_long]], BTN_GESTURE_NONE);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(gesture_table, rejects_invalid_patterns) {
+  const char* const bad_symbol[] = { ".x" };
+  assertFalse(Button2GestureTable<8>(bad_symbol).valid);
+  const char* const hold_not_last[] = { "_." };
+  assertFalse(Button2GestureTable<8>(hold_not_last).valid);
+  const char* const too_long[] = { "........" };
+  assertFalse(Button2GestureTable<8>(too_long).valid);
+}
+
+/////////////////////////////////////////////////////////////////
+// RECOGNIZER TESTS
+/////////////////////////////////////////////////////////////////
+
+test(gesture, click_waits_for_gap) {
+  Button2GestureRecognizer g;
+  Button2 button = createGestureButton();
+  assertTrue(g.begin(button, table, onGesture));
+
+  pressFor(g, SHORT_MS);
+  // ".." is still possible
+  assertEqual(gestureCount, 0);
+  run(g, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(lastGesture, CLICK);
+  assertEqual(gestureCount, 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(gesture, click_then_hold) {
+  Button2GestureRecognizer g;
+  Button2 button = createGestureButton();
+  g.begin(button, table, onGesture);
+
+  pressFor(g, SHORT_MS);
+  simulatedPinState = BUTTON_ACTIVE;
+  run(g, LONG_MS);
+  // reported while still held
+  assertEqual(lastGesture, CLICK_HOLD);
+  simulatedPinState = !BUTTON_ACTIVE;
+  run(g, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(gestureCount, 1);
+  assertEqual(g.getState(), 0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(gesture, long_short_long_reported_on_last_release) {
+  Button2GestureRecognizer g;
+  Button2 button = createGestureButton();
+  g.begin(button, table, onGesture);
+
+  pressFor(g, LONG_MS);
+  pressFor(g, SHORT_MS);
+  pressFor(g, LONG_MS);
+  // leaf of the DFA: no need to wait for the gap
+  assertEqual(lastGesture, LONG_SHORT_LONG);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(gesture, mismatch_resets) {
+  Button2GestureRecognizer g;
+  Button2 button = createGestureButton();
+  g.begin(button, table, onGesture);
+
+  // "--" is no prefix of any gesture
+  pressFor(g, LONG_MS);
+  pressFor(g, LONG_MS);
+  assertEqual(g.getState(), 0);
+  run(g, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(gestureCount, 0);
+
+  // a prefix without a gesture of its own reports nothing
+  pressFor(g, LONG_MS);
+  pressFor(g, SHORT_MS);
+  run(g, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(gestureCount, 0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(gesture, click_handlers_still_called) {
+  static int clicks;
+  clicks = 0;
+  Button2GestureRecognizer g;
+  Button2 button = createGestureButton();
+  button.setDoubleClickHandler([](Button2& b) { clicks++; });
+  g.begin(button, table, onGesture);
+
+  pressFor(g, SHORT_MS);
+  pressFor(g, SHORT_MS);
+  run(g, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(lastGesture, DOUBLE);
+  assertEqual(clicks, 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(gesture, table_in_flash) {
+  Button2GestureRecognizer g;
+  Button2 button = createGestureButton();
+  assertTrue(g.begin_P(button, table_P, onGesture));
+
+  pressFor(g, LONG_MS);
+  pressFor(g, SHORT_MS);
+  pressFor(g, LONG_MS);
+  assertEqual(lastGesture, LONG_SHORT_LONG);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(gesture, event_handler_stays_free) {
+  static int events;
+  events = 0;
+  Button2GestureRecognizer g;
+  Button2 button = createGestureButton();
+  button.setEventHandler([](Button2& b, buttonEvent ev) {
+    if (ev == click_event) events++;
+  });
+  g.begin(button, table, onGesture);
+
+  pressFor(g, SHORT_MS);
+  run(g, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(lastGesture, CLICK);
+  assertEqual(events, 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(gesture, hold_timed_from_the_press_edge) {
+  Button2GestureRecognizer g;
+  Button2 button = createGestureButton();
+  // the press is reported on the first edge, without the debounce time
+  button.setDebounceMode(debounce_lockout);
+  g.begin(button, table, onGesture);
+
+  pressFor(g, SHORT_MS);
+  // past the lockout of the release
+  run(g, DEBOUNCE_MS);
+  simulatedPinState = BUTTON_ACTIVE;
+  run(g, BTN_LONGCLICK_MS - 20);
+  assertEqual(gestureCount, 0);
+  run(g, 30);
+  assertEqual(lastGesture, CLICK_HOLD);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+  useTestClock();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Gesture Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,165 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Microsecond mode tests for Button2 library.
+  Tests sub-ms debounce windows and press durations, and the
+  wraparound of the 32 bit micros() clock after ~71 minutes.
+
+  Created by Lennart Hennigs
+  Requires -DBUTTON2_USE_MICROS, see the test_micros environment
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+
+#ifdef BUTTON2_USE_MICROS
+
+static int clicks;
+static int doubleClicks;
+static int longDetected;
+
+Button2 createMicrosButton(uint32_t start_us) {
+  // in us, 32 bits: the tests hit the real overflow on 64 bit hosts too
+  useTestClock(start_us);
+  Button2 button = createTestButton();
+  clicks = doubleClicks = longDetected = 0;
+  button.setClickHandler([](Button2& btn) { clicks++; });
+  button.setDoubleClickHandler([](Button2& btn) { doubleClicks++; });
+  button.setLongClickDetectedHandler([](Button2& btn) { longDetected++; });
+  return button;
+}
+
+// scan the button at 10 kHz for `us`
+void scan(Button2& button, uint8_t level, unsigned long us) {
+  simulatedPinState = level;
+  for (unsigned long t = 0; t < us; t += 100) {
+    button.loop();
+    virtualTime += 100;
+  }
+}
+
+#define PRESSED   BUTTON_ACTIVE
+#define RELEASED  !BUTTON_ACTIVE
+
+// `before` us ahead of the 2^32 us (~71.6 minutes) clock overflow
+#define WRAP_US(before) ((uint32_t)0 - (uint32_t)(before))
+
+/////////////////////////////////////////////////////////////////
+// MICROS TESTS
+/////////////////////////////////////////////////////////////////
+
+test(micros, timeouts_kept_in_us) {
+  Button2 button = createMicrosButton(0);
+  assertEqual(button.getDebounceTime(), BTN_DEBOUNCE_MS);
+  button.setLongClickTime(250);
+  assertEqual(button.getLongClickTime(), 250U);
+  button.setDebounceTimeUs(300, 200);
+  assertEqual(button.getDebounceTime(), 0U);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(micros, sub_ms_debounce) {
+  Button2 button = createMicrosButton(1000);
+  button.setDebounceTimeUs(300);
+
+  static int pressed;
+  pressed = 0;
+  button.setPressedHandler([](Button2& btn) { pressed++; });
+
+  scan(button, PRESSED, 200);
+  scan(button, RELEASED, 500);
+  assertEqual(pressed, 0);
+
+  scan(button, PRESSED, 400);
+  assertEqual(pressed, 1);
+  scan(button, RELEASED, (BTN_DOUBLECLICK_MS + 1) * 1000UL);
+  assertEqual(clicks, 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(micros, pressed_for_in_us) {
+  Button2 button = createMicrosButton(0);
+  button.setDebounceTimeUs(100);
+  scan(button, PRESSED, 1300);
+  scan(button, RELEASED, 100);
+  assertEqual(button.wasPressedForUs(), 1300UL);
+  assertEqual(button.wasPressedFor(), 1U);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(micros, deadline_rounded_up_to_ms) {
+  Button2 button = createMicrosButton(0);
+  scan(button, PRESSED, 20000);
+  // 30ms left of the debounce time, partial ms are rounded up
+  assertEqual(button.timeToNextDeadline(), 30UL);
+  virtualTime += 50;
+  assertEqual(button.timeToNextDeadline(), 30UL);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(micros, double_click_across_wraparound) {
+  // first click ~71.6 minutes after start, the clock wraps in between
+  Button2 button = createMicrosButton(WRAP_US(100000));
+  scan(button, PRESSED, 60000);
+  scan(button, RELEASED, 60000);
+  assertTrue(virtualTime < (uint32_t)100000);
+  scan(button, PRESSED, 60000);
+  scan(button, RELEASED, (BTN_DOUBLECLICK_MS + 1) * 1000UL);
+  assertEqual(doubleClicks, 1);
+  assertEqual(clicks, 0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(micros, long_click_across_wraparound) {
+  Button2 button = createMicrosButton(WRAP_US(50000));
+  scan(button, PRESSED, (BTN_LONGCLICK_MS - 10) * 1000UL);
+  assertEqual(longDetected, 0);
+  scan(button, PRESSED, 20000);
+  assertEqual(longDetected, 1);
+  scan(button, RELEASED, 100);
+  assertEqual(button.wasPressedFor(), BTN_LONGCLICK_MS + 10);
+}
+
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Microsecond Mode Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
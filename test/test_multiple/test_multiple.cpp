@@ -74,17 +74,17 @@ void click(Button2& button, uint8_t* stateVar, unsigned long duration) {
   *stateVar = BUTTON_ACTIVE;
   button.loop();
 
-  unsigned long startTime = millis();
+  unsigned long startTime = testMillis();
   unsigned long endTime = startTime + duration;
 
-  while (millis() < endTime) {
+  while (testMillis() < endTime) {
     button.loop();
-    delay(1);
+    testDelay(1);
   }
 
   *stateVar = !BUTTON_ACTIVE;
   button.loop();
-  delay(5);
+  testDelay(5);
   button.loop();
 }
 
@@ -163,14 +163,14 @@ test(multiple, shared_handler_different_buttons) {
 
   // Click button1
   click(button1, &simulatedPin37State, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button1.loop();
 
   assertEqual(g_last_button_id, 1);
 
   // Click button2
   click(button2, &simulatedPin38State, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button2.loop();
 
   assertEqual(g_last_button_id, 2);
@@ -197,7 +197,7 @@ test(multiple, unique_handlers_per_button) {
 
   // Click button1
   click(button1, &simulatedPin37State, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button1.loop();
 
   assertEqual(g_button1_clicks, 1);
@@ -205,7 +205,7 @@ test(multiple, unique_handlers_per_button) {
 
   // Click button2
   click(button2, &simulatedPin38State, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button2.loop();
 
   assertEqual(g_button1_clicks, 1);
@@ -230,7 +230,7 @@ test(multiple, simultaneous_button_presses) {
   button1.loop();
   button2.loop();
 
-  delay(DEBOUNCE_MS);
+  testDelay(DEBOUNCE_MS);
 
   button1.loop();
   button2.loop();
@@ -264,7 +264,7 @@ test(multiple, independent_click_counting) {
 
   // Single click button1
   click(button1, &simulatedPin37State, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button1.loop();
 
   assertEqual(button1.getNumberOfClicks(), 1);
@@ -273,7 +273,7 @@ test(multiple, independent_click_counting) {
   // Double click button2
   click(button2, &simulatedPin38State, DEBOUNCE_MS);
   click(button2, &simulatedPin38State, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button2.loop();
 
   assertEqual(button1.getNumberOfClicks(), 1);
@@ -344,7 +344,7 @@ test(multiple, array_of_buttons) {
   // Click each button in sequence
   for (int i = 0; i < NUM_BUTTONS; i++) {
     click(buttons[i], stateVars[i], DEBOUNCE_MS);
-    delay(BTN_DOUBLECLICK_MS);
+    testDelay(BTN_DOUBLECLICK_MS);
     buttons[i].loop();
 
     assertEqual(g_last_button_id, i);
@@ -381,7 +381,7 @@ test(multiple, independent_state_management) {
 
   // Click button1
   click(button1, &simulatedPin37State, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button1.loop();
 
   // button1 should show wasPressed, button2 should not
@@ -396,7 +396,7 @@ test(multiple, independent_state_management) {
 
   // Click button2
   click(button2, &simulatedPin38State, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button2.loop();
 
   // button2 should show wasPressed, button1 should not
@@ -424,12 +424,12 @@ test(multiple, alternating_button_clicks) {
   for (int i = 0; i < 3; i++) {
     // Click button1
     click(button1, &simulatedPin37State, DEBOUNCE_MS);
-    delay(BTN_DOUBLECLICK_MS);
+    testDelay(BTN_DOUBLECLICK_MS);
     button1.loop();
 
     // Click button2
     click(button2, &simulatedPin38State, DEBOUNCE_MS);
-    delay(BTN_DOUBLECLICK_MS);
+    testDelay(BTN_DOUBLECLICK_MS);
     button2.loop();
   }
 
@@ -464,11 +464,11 @@ test(multiple, context_independent_per_button) {
   button2.setClickHandler(handler);
 
   click(button1, &simulatedPin37State, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS + 10);
+  testDelay(BTN_DOUBLECLICK_MS + 10);
   button1.loop();
 
   click(button2, &simulatedPin38State, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS + 10);
+  testDelay(BTN_DOUBLECLICK_MS + 10);
   button2.loop();
 
   assertEqual(ctx1.received, 1);
@@ -479,6 +479,7 @@ test(multiple, context_independent_per_button) {
 
 void setup() {
   setup_test_runner();
+  useTestClock();
 
   delay(100);  // Reduced for faster native testing
   Serial.begin(SERIAL_SPEED);
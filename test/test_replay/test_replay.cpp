@@ -0,0 +1,249 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Replay tests for Button2 library.
+  Tests Button2Replay: recorded samples run on a virtual clock give
+  the same events at the same times as a button polled every ms.
+
+  Created by Lennart Hennigs
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+#include <Button2Replay.h>
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+
+#define PRESSED   BUTTON_ACTIVE
+#define RELEASED  !BUTTON_ACTIVE
+
+// events with their times, as seen by the event handler
+#define MAX_EVENTS 200
+
+struct EventLog {
+  unsigned long times[MAX_EVENTS];
+  uint8_t events[MAX_EVENTS];
+  uint16_t count = 0;
+
+  void add(buttonEvent ev, unsigned long time) {
+    if (count == MAX_EVENTS) return;
+    times[count] = time;
+    events[count++] = ev;
+  }
+};
+
+static EventLog polled;
+static EventLog replayed;
+
+// a session with bounces, clicks, double clicks and long clicks:
+// the level changes at these times (ms), starting pressed
+const unsigned long changes[] = {
+  1000, 1004, 1007, 1120,                 // bouncing click
+  2000, 2090, 2200, 2280,                 // double click
+  3000, 3700,                             // long click
+  4000, 4030,                             // too short
+  5000, 5100, 5200, 5260, 5390, 5470,     // triple click
+  7000, 7002, 7003, 7600                  // bouncing long click
+};
+const uint8_t CHANGES = sizeof(changes) / sizeof(changes[0]);
+const unsigned long SESSION_END = 9000;
+
+// the button polled every ms with the scripted clock
+void runPolled() {
+  useTestClock(0);
+  Button2 button = createTestButton();
+  polled.count = 0;
+  button.setEventHandler([](Button2& btn, buttonEvent ev) { polled.add(ev, virtualTime); });
+
+  uint8_t next = 0;
+  for (virtualTime = 0; virtualTime < SESSION_END; virtualTime++) {
+    if (next < CHANGES && changes[next] == virtualTime) next++;
+    simulatedPinState = (next % 2) ? PRESSED : RELEASED;
+    button.loop();
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+// REPLAY TESTS
+/////////////////////////////////////////////////////////////////
+
+test(replay, matches_polled_loop) {
+  runPolled();
+
+  Button2 button;
+  Button2Replay replay;
+  replay.begin(button);
+  simulatedPinState = RELEASED;
+  button.setButtonStateFunction(getSimulatedPinState);
+  button.begin(BTN_VIRTUAL_PIN, BUTTON_MODE, BUTTON_ACTIVE == LOW);
+  replayed.count = 0;
+  replay.setEventHandler([](Button2& btn, buttonEvent ev, unsigned long time) { replayed.add(ev, time); });
+
+  for (uint8_t i = 0; i < CHANGES; i++) {
+    replay.sample((i % 2) ? RELEASED : PRESSED, changes[i]);
+  }
+  replay.advanceTo(SESSION_END);
+  replay.end();
+
+  assertEqual(replay.getSamples(), (uint32_t)CHANGES);
+  assertEqual(replay.getEventCount(double_click_event), (uint32_t)1);
+  assertEqual(replay.getEventCount(triple_click_event), (uint32_t)1);
+  assertEqual(replay.getEventCount(long_click_event), (uint32_t)2);
+  assertEqual(replayed.count, polled.count);
+  for (uint16_t i = 0; i < polled.count; i++) {
+    assertEqual(replayed.events[i], polled.events[i]);
+    assertEqual(replayed.times[i], polled.times[i]);
+  }
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(replay, hours_in_no_time) {
+  Button2 button;
+  Button2Replay replay;
+  replay.begin(button);
+  simulatedPinState = RELEASED;
+  button.setButtonStateFunction(getSimulatedPinState);
+  button.begin(BTN_VIRTUAL_PIN, BUTTON_MODE, BUTTON_ACTIVE == LOW);
+
+  // ten hours, a click every two seconds
+  unsigned long start = millis();
+  const uint32_t CLICKS = 10UL * 3600 / 2;
+  for (uint32_t i = 0; i < CLICKS; i++) {
+    replay.sample(PRESSED, i * 2000);
+    replay.sample(RELEASED, i * 2000 + 80);
+  }
+  replay.finish();
+  replay.end();
+  assertEqual(replay.getEventCount(click_event), CLICKS);
+  assertMore(replay.getTime(), 10UL * 3600 * 1000 - 2000);
+  assertLess(millis() - start, 5000UL);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(replay, recorded_trace) {
+  // record the session of the polled button
+  Button2TraceRecorder recorder;
+  recorder.begin();
+  runPolled();
+  recorder.end();
+
+  uint8_t bytes[BUTTON2_TRACE_SIZE];
+  uint16_t len = recorder.copyTo(bytes, sizeof(bytes));
+  Button2TraceReader reader(bytes, len, recorder.getBaseTime());
+  Button2TraceRecord first;
+  assertTrue(reader.next(first));
+
+  Button2 button;
+  Button2Replay replay;
+  replay.begin(button);
+  simulatedPinState = RELEASED;
+  button.setButtonStateFunction(getSimulatedPinState);
+  button.begin(BTN_VIRTUAL_PIN, BUTTON_MODE, BUTTON_ACTIVE == LOW);
+  // the replaying button doesn't need the ID of the recorded one
+  assertNotEqual(button.getID(), (int)first.id);
+  replayed.count = 0;
+  replay.setEventHandler([](Button2& btn, buttonEvent ev, unsigned long time) { replayed.add(ev, time); });
+
+  Button2TraceReader all(bytes, len, recorder.getBaseTime());
+  assertEqual(replay.replay(all, first.id), (uint32_t)CHANGES);
+  replay.end();
+  assertEqual(replayed.count, polled.count);
+  assertEqual(replayed.times[replayed.count - 1], polled.times[polled.count - 1]);
+}
+
+/////////////////////////////////////////////////////////////////
+
+// collects printed text
+class TextPrint : public Print {
+ public:
+  String text;
+  size_t write(uint8_t c) override {
+    text += (char)c;
+    return 1;
+  }
+};
+
+test(replay, events_as_csv) {
+  Button2 button;
+  Button2Replay replay;
+  replay.begin(button, 1000);
+  simulatedPinState = RELEASED;
+  button.setButtonStateFunction(getSimulatedPinState);
+  button.begin(BTN_VIRTUAL_PIN, BUTTON_MODE, BUTTON_ACTIVE == LOW);
+  TextPrint out;
+  replay.setOutput(out);
+
+  replay.sample(PRESSED, 1000);
+  replay.sample(RELEASED, 1100);
+  replay.finish();
+  replay.end();
+
+  String expected = "1050,changed\n1050,pressed\n1100,changed\n1100,released\n1100,tap\n";
+  expected += "1301,click\n";
+  assertEqual(out.text, expected);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(replay, handlers_and_clock_stay_with_the_application) {
+  static int events;
+  events = 0;
+  useTestClock(500);
+
+  Button2 button;
+  Button2Replay replay;
+  replay.begin(button, 1000);
+  simulatedPinState = RELEASED;
+  button.setButtonStateFunction(getSimulatedPinState);
+  button.begin(BTN_VIRTUAL_PIN, BUTTON_MODE, BUTTON_ACTIVE == LOW);
+  button.setEventHandler([](Button2& btn, buttonEvent ev) { events++; });
+
+  replay.sample(PRESSED, 1000);
+  replay.sample(RELEASED, 1100);
+  replay.finish();
+  assertEqual(button.getTime(), 1301UL);
+  replay.end();
+
+  // changed, pressed, changed, released, tap, click
+  assertEqual(events, 6);
+  assertEqual(replay.getEventCount(click_event), (uint32_t)1);
+  // the clock that was set before is back
+  assertEqual(button.getTime(), 500UL);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Replay Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
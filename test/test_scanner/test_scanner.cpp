@@ -0,0 +1,321 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Background scanner tests for Button2 library.
+  Tests the scan task, the event queue and the std::thread backend.
+  The event tests run the scan task in lockstep with the virtual
+  clock (SteppedBackend), only the timing tests use real time.
+
+  Created by Lennart Hennigs
+  Runs on the native (EpoxyDuino) environments only
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+#include <Button2Scanner.h>
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+
+#ifdef BUTTON2_HAS_SCANNER
+
+// written by the test thread, read by the scan thread
+static std::atomic<uint8_t> threadedPinState(HIGH);
+
+uint8_t getThreadedPinState() {
+  return threadedPinState;
+}
+
+Button2 createScannedButton() {
+  Button2 button;
+  threadedPinState = !BUTTON_ACTIVE;
+  button.setButtonStateFunction(getThreadedPinState);
+  button.begin(BUTTON_PIN, BUTTON_MODE, BUTTON_ACTIVE == LOW);
+  button.setDoubleClickTime(100);
+  return button;
+}
+
+// Runs the scan task in lockstep with the test: every period moves the
+// virtual clock, and the task only runs the periods the test hands out
+// with run() or waitForSignal(). Pin changes between two run() calls
+// are seen by the next scan, whatever the load of the host.
+class SteppedBackend : public Button2TaskBackend {
+ protected:
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable cond;
+  unsigned long budget = 0;   // ms the task may still run
+  unsigned long period = 1;
+  bool parked = false;        // task waits in waitForNextPeriod()
+  bool stopping = false;
+  bool signaled = false;
+
+  // called with the lock held: hand out `ms`, wait until they are used
+  void _step(std::unique_lock<std::mutex>& lock, unsigned long ms) {
+    budget += ms;
+    cond.notify_all();
+    cond.wait(lock, [this] { return stopping || (parked && budget < period); });
+  }
+
+ public:
+  ~SteppedBackend() {
+    join();
+  }
+
+  bool start(TaskFunction fn, void* arg, uint8_t /* priority */, uint32_t /* stackSize */) override {
+    if (thread.joinable()) return false;
+    budget = 0;
+    parked = false;
+    stopping = false;
+    thread = std::thread(fn, arg);
+    return true;
+  }
+
+  void join() override {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    cond.notify_all();
+    if (thread.joinable()) thread.join();
+  }
+
+  void waitForNextPeriod(unsigned long period_ms) override {
+    std::unique_lock<std::mutex> lock(mutex);
+    period = period_ms;
+    parked = true;
+    cond.notify_all();
+    cond.wait(lock, [this] { return stopping || budget >= period; });
+    parked = false;
+    if (stopping) return;
+    budget -= period;
+    virtualTime += period;
+  }
+
+  void signal() override {
+    std::lock_guard<std::mutex> lock(mutex);
+    signaled = true;
+  }
+
+  // runs the task up to `timeout_ms` of virtual time
+  bool waitForSignal(unsigned long timeout_ms) override {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (unsigned long t = 0; !signaled && !stopping && t < timeout_ms; t += period) {
+      _step(lock, period);
+    }
+    bool res = signaled;
+    signaled = false;
+    return res;
+  }
+
+  // let the task scan for `ms` of virtual time
+  void run(unsigned long ms) {
+    std::unique_lock<std::mutex> lock(mutex);
+    _step(lock, ms);
+  }
+};
+
+// wait for the next event of the given type, skipping others
+bool waitForEvent(Button2Scanner& scanner, buttonEvent type, unsigned long timeout_ms) {
+  Button2Event ev;
+  unsigned long start = millis();
+  while (millis() - start < timeout_ms) {
+    if (scanner.nextEvent(ev, 10) && ev.type == type) return true;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////////////////////
+// SCANNER TESTS
+/////////////////////////////////////////////////////////////////
+
+test(scanner, scans_periodically) {
+  Button2 button = createScannedButton();
+  Button2Scanner scanner;
+  assertTrue(scanner.add(button));
+  assertTrue(scanner.begin(2));
+  assertTrue(scanner.isRunning());
+  delay(50);
+  scanner.end();
+  assertFalse(scanner.isRunning());
+
+  uint32_t scans = scanner.getScanCount();
+  assertTrue(scans >= 5);
+  // no scans after end()
+  delay(20);
+  assertEqual(scanner.getScanCount(), scans);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(scanner, click_events_reach_application) {
+  useTestClock(0);
+  Button2 button = createScannedButton();
+  SteppedBackend backend;
+  Button2Scanner scanner(backend);
+  scanner.add(button);
+  scanner.begin(2);
+
+  threadedPinState = BUTTON_ACTIVE;
+  backend.run(DEBOUNCE_MS + 10);
+  threadedPinState = !BUTTON_ACTIVE;
+
+  Button2Event ev;
+  assertTrue(scanner.nextEvent(ev, 500));
+  assertEqual(ev.type, changed_event);
+  assertTrue(ev.button == &button);
+  assertTrue(scanner.nextEvent(ev, 500));
+  assertEqual(ev.type, pressed_event);
+  assertTrue(waitForEvent(scanner, tap_event, 500));
+  assertTrue(waitForEvent(scanner, click_event, 500));
+  scanner.end();
+  assertEqual(scanner.getDroppedEvents(), (uint32_t)0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(scanner, handlers_still_called) {
+  static std::atomic<int> clicks(0);
+  clicks = 0;
+  useTestClock(0);
+  Button2 button = createScannedButton();
+  button.setClickHandler([](Button2& b) {
+    clicks++;
+  });
+  SteppedBackend backend;
+  Button2Scanner scanner(backend);
+  scanner.add(button);
+  scanner.begin(2);
+
+  threadedPinState = BUTTON_ACTIVE;
+  backend.run(DEBOUNCE_MS + 10);
+  threadedPinState = !BUTTON_ACTIVE;
+
+  assertTrue(waitForEvent(scanner, click_event, 500));
+  scanner.end();
+  assertEqual(clicks.load(), 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(scanner, event_handler_stays_with_the_application) {
+  static std::atomic<int> events(0);
+  events = 0;
+  useTestClock(0);
+  Button2 button = createScannedButton();
+  Button2 other = createScannedButton();
+  button.setEventHandler([](Button2& b, buttonEvent ev) {
+    if (ev == click_event) events++;
+  });
+  SteppedBackend backend;
+  Button2Scanner scanner(backend);
+  scanner.add(button);
+  scanner.begin(2);
+
+  threadedPinState = BUTTON_ACTIVE;
+  backend.run(DEBOUNCE_MS + 10);
+  threadedPinState = !BUTTON_ACTIVE;
+
+  assertTrue(waitForEvent(scanner, click_event, 500));
+  scanner.end();
+  assertEqual(events.load(), 1);
+
+  // the events of buttons that are not scanned are not queued
+  Button2Event ev;
+  while (scanner.nextEvent(ev)) {}
+  other.setDebounceTime(0);
+  threadedPinState = BUTTON_ACTIVE;
+  other.loop();
+  assertTrue(other.isPressed());
+  assertFalse(scanner.nextEvent(ev));
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(scanner, next_event_times_out) {
+  Button2 button = createScannedButton();
+  Button2Scanner scanner;
+  scanner.add(button);
+  scanner.begin(2);
+
+  Button2Event ev;
+  unsigned long start = millis();
+  assertFalse(scanner.nextEvent(ev, 30));
+  assertTrue(millis() - start >= 30);
+  assertFalse(scanner.nextEvent(ev));
+  scanner.end();
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(scanner, full_queue_drops_events) {
+  useTestClock(0);
+  Button2 button = createScannedButton();
+  button.setDebounceTime(0);
+  SteppedBackend backend;
+  Button2Scanner scanner(backend);
+  scanner.add(button);
+  scanner.begin(1);
+
+  // nobody consumes: press/release events pile up
+  for (int i = 0; i < BUTTON2_SCANNER_QUEUE_SIZE; i++) {
+    threadedPinState = BUTTON_ACTIVE;
+    backend.run(5);
+    threadedPinState = !BUTTON_ACTIVE;
+    backend.run(5);
+  }
+  scanner.end();
+  assertEqual(scanner.available(), (uint8_t)BUTTON2_SCANNER_QUEUE_SIZE);
+  assertTrue(scanner.getDroppedEvents() > 0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(scanner, add_rejected_while_running) {
+  Button2 button = createScannedButton();
+  Button2 other = createScannedButton();
+  Button2Scanner scanner;
+  scanner.add(button);
+  scanner.begin(2);
+  assertFalse(scanner.add(other));
+  assertFalse(scanner.begin(2));
+  scanner.end();
+  assertTrue(scanner.add(other));
+  assertEqual(scanner.getButtonCount(), (uint8_t)2);
+}
+
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Scanner Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,261 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Shared-memory export tests for Button2 library.
+  Tests the segment layout, the event ring and a second process
+  observing the buttons.
+
+  Created by Lennart Hennigs
+  Runs on the native (EpoxyDuino) environments on Linux only
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+#include <Button2Shm.h>
+
+#ifdef BUTTON2_HAS_SHM
+#include <stdio.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+
+#ifdef BUTTON2_HAS_SHM
+
+static char segment[64];
+
+const char* segmentName() {
+  snprintf(segment, sizeof(segment), "/button2_test_%d", (int)getpid());
+  return segment;
+}
+
+/////////////////////////////////////////////////////////////////
+// SHARED MEMORY TESTS
+/////////////////////////////////////////////////////////////////
+
+test(shm, reader_needs_segment) {
+  Button2ShmReader reader;
+  assertFalse(reader.begin("/button2_does_not_exist"));
+  assertFalse(reader.isOpen());
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(shm, segment_has_a_single_publisher) {
+  Button2ShmPublisher publisher;
+  assertTrue(publisher.begin(segmentName()));
+  Button2ShmPublisher second;
+  assertFalse(second.begin(segmentName()));
+  assertTrue(publisher.isOpen());
+
+  // a segment left behind by a crash is removed explicitly
+  close(shm_open("/button2_test_stale", O_CREAT | O_RDWR, 0644));
+  assertFalse(second.begin("/button2_test_stale"));
+  assertTrue(Button2ShmPublisher::removeSegment("/button2_test_stale"));
+  assertTrue(second.begin("/button2_test_stale"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(shm, name_must_fit) {
+  char name[BUTTON2_SHM_MAX_NAME + 1];
+  memset(name, 'x', sizeof(name));
+  name[0] = '/';
+  name[BUTTON2_SHM_MAX_NAME] = '\0';
+  Button2ShmPublisher publisher;
+  assertFalse(publisher.begin(name));
+  name[BUTTON2_SHM_MAX_NAME - 1] = '\0';
+  assertTrue(publisher.begin(name));
+  publisher.end();
+  Button2ShmReader reader;
+  assertFalse(reader.begin(name));
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(shm, publishes_pressed_bitmap_and_counters) {
+  Button2 button = createTestButton();
+  Button2ShmPublisher publisher;
+  assertTrue(publisher.begin(segmentName()));
+  assertTrue(publisher.add(button));
+
+  Button2ShmReader reader;
+  assertTrue(reader.begin(segmentName()));
+  assertEqual(reader.getButtonCount(), 1);
+  assertEqual(reader.getButtonID(0), button.getID());
+
+  pressAndHold(button, DEBOUNCE_MS);
+  assertTrue(reader.isPressed(0));
+
+  release(button);
+  assertFalse(reader.isPressed(0));
+  click(button, DEBOUNCE_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
+  button.loop();
+
+  Button2ShmState state;
+  reader.read(state);
+  assertEqual(state.pressed, (uint64_t)0);
+  assertEqual(state.counters[0].events[pressed_event], (uint32_t)2);
+  assertEqual(state.counters[0].events[released_event], (uint32_t)2);
+  assertEqual(state.counters[0].events[double_click_event], (uint32_t)1);
+  assertEqual(state.counters[0].last_clicks, (uint32_t)2);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(shm, add_publishes_held_button_once) {
+  Button2 button = createTestButton();
+  pressAndHold(button, DEBOUNCE_MS);
+  Button2ShmPublisher publisher;
+  assertTrue(publisher.begin(segmentName()));
+  assertTrue(publisher.add(button));
+  assertFalse(publisher.add(button));
+  assertEqual(publisher.getButtonCount(), 1);
+
+  Button2ShmReader reader;
+  assertTrue(reader.begin(segmentName()));
+  assertTrue(reader.isPressed(0));
+  release(button);
+  assertFalse(reader.isPressed(0));
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(shm, event_ring_in_order) {
+  static uint8_t handled = 0;
+  handled = 0;
+  Button2 button = createTestButton();
+  button.setEventHandler([](Button2& b, buttonEvent ev) {
+    handled++;
+  });
+  Button2ShmPublisher publisher;
+  publisher.begin(segmentName());
+  publisher.add(button);
+  Button2ShmReader reader;
+  reader.begin(segmentName());
+
+  click(button, DEBOUNCE_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
+  button.loop();
+
+  const buttonEvent expected[] = { changed_event, pressed_event, changed_event, released_event, tap_event, click_event };
+  Button2ShmEvent ev;
+  for (uint8_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+    assertTrue(reader.nextEvent(ev));
+    assertEqual(ev.type, expected[i]);
+    assertEqual(ev.button, 0);
+  }
+  assertEqual(ev.clicks, 1);
+  assertFalse(reader.nextEvent(ev));
+  assertEqual(reader.getLostEvents(), (uint32_t)0);
+  // the button's own event handler still gets all events
+  assertEqual(handled, (uint8_t)6);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(shm, slow_reader_counts_lost_events) {
+  Button2 button = createTestButton();
+  button.setDebounceTime(0);
+  Button2ShmPublisher publisher;
+  publisher.begin(segmentName());
+  publisher.add(button);
+  Button2ShmReader reader;
+  reader.begin(segmentName());
+
+  // 5 events per press/release, more than the ring can hold
+  for (int i = 0; i < BUTTON2_SHM_RING_SIZE; i++) {
+    simulatedPinState = BUTTON_ACTIVE;
+    button.loop();
+    button.loop();
+    simulatedPinState = !BUTTON_ACTIVE;
+    button.loop();
+  }
+
+  Button2ShmEvent ev;
+  uint32_t received = 0;
+  while (reader.nextEvent(ev)) received++;
+  assertEqual(received, (uint32_t)BUTTON2_SHM_RING_SIZE);
+  assertTrue(reader.getLostEvents() > 0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(shm, second_process_observes_buttons) {
+  Button2 button = createTestButton();
+  // the name contains our pid, resolve it before forking
+  const char* name = segmentName();
+  Button2ShmPublisher publisher;
+  assertTrue(publisher.begin(name));
+  publisher.add(button);
+
+  pid_t child = fork();
+  if (child == 0) {
+    // reader process: wait for a click, then check the bitmap
+    Button2ShmReader reader;
+    if (!reader.begin(name)) _exit(1);
+    Button2ShmEvent ev;
+    unsigned long start = millis();
+    while (millis() - start < 5000) {
+      if (reader.nextEvent(ev) && ev.type == click_event) {
+        _exit(reader.isPressed(0) ? 3 : 0);
+      }
+      delay(1);
+    }
+    _exit(2);
+  }
+  assertTrue(child > 0);
+
+  // give the reader time to map the segment before the events start
+  delay(100);
+  click(button, DEBOUNCE_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
+  button.loop();
+
+  int status = -1;
+  waitpid(child, &status, 0);
+  assertTrue(WIFEXITED(status));
+  assertEqual(WEXITSTATUS(status), 0);
+}
+
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+  useTestClock();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Shared Memory Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,223 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Snapshot tests for Button2 library.
+  Tests getSnapshot() and the seqlock under concurrent readers.
+
+  Created by Lennart Hennigs
+  The stress test runs on the native (EpoxyDuino) environments only
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+
+#if defined(EPOXY_DUINO)
+#include <atomic>
+#include <thread>
+#endif
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+// SNAPSHOT TESTS
+/////////////////////////////////////////////////////////////////
+
+test(snapshot, initial_state) {
+  Button2 button = createTestButton();
+  ButtonSnapshot snap = button.getSnapshot();
+
+  assertFalse(snap.pressed);
+  assertFalse(snap.was_pressed);
+  assertEqual(snap.clicks, 0);
+  assertEqual(snap.type, clickType::empty);
+  assertEqual(snap.longclick_count, 0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(snapshot, matches_getters_after_double_click) {
+  Button2 button = createTestButton();
+  click(button, DEBOUNCE_MS);
+  click(button, DEBOUNCE_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
+  button.loop();
+
+  ButtonSnapshot snap = button.getSnapshot();
+  assertEqual(snap.pressed, button.isPressed());
+  assertEqual(snap.was_pressed, button.wasPressed());
+  assertEqual(snap.clicks, button.getNumberOfClicks());
+  assertEqual(snap.type, button.getType());
+  assertEqual(snap.pressed_for, button.wasPressedFor());
+  assertEqual(snap.type, double_click);
+  assertEqual(snap.clicks, 2);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(snapshot, tracks_pressed_state) {
+  Button2 button = createTestButton();
+  press(button);
+  assertTrue(button.getSnapshot().pressed);
+  release(button);
+  assertFalse(button.getSnapshot().pressed);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(snapshot, reflects_read) {
+  Button2 button = createTestButton();
+  click(button, DEBOUNCE_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
+  button.loop();
+  assertTrue(button.getSnapshot().was_pressed);
+
+  button.read();
+  ButtonSnapshot snap = button.getSnapshot();
+  assertFalse(snap.was_pressed);
+  assertEqual(snap.type, clickType::empty);
+  assertEqual(snap.clicks, 0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+static ButtonSnapshot handlerSnap;
+
+void snapshotHandler(Button2& btn) {
+  handlerSnap = btn.getSnapshot();
+}
+
+test(snapshot, readable_from_handler) {
+  Button2 button = createTestButton();
+  handlerSnap = ButtonSnapshot();
+  button.setDoubleClickHandler(snapshotHandler);
+  click(button, DEBOUNCE_MS);
+  click(button, DEBOUNCE_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
+  button.loop();
+
+  // the result is published before the handler runs
+  assertEqual(handlerSnap.type, double_click);
+  assertEqual(handlerSnap.clicks, 2);
+  assertTrue(handlerSnap.was_pressed);
+
+  button.setLongClickDetectedHandler(snapshotHandler);
+  pressAndHold(button, BTN_LONGCLICK_MS + 10);
+  assertTrue(handlerSnap.pressed);
+  assertEqual(handlerSnap.type, long_click);
+  assertEqual(handlerSnap.longclick_count, 1);
+  release(button);
+}
+
+/////////////////////////////////////////////////////////////////
+
+#if defined(EPOXY_DUINO)
+
+// The writer cycles through three states, each one changes several
+// fields at once. A torn read would mix fields of different states.
+static bool isConsistent(const ButtonSnapshot& s) {
+  if (s.type == clickType::empty) return s.clicks == 0 && !s.was_pressed;
+  if (s.type == single_click) return s.clicks == 1 && s.was_pressed;
+  if (s.type == double_click) return s.clicks == 2 && s.was_pressed;
+  return false;
+}
+
+static std::atomic<uint8_t> stressPinState(HIGH);
+
+uint8_t getStressPinState() {
+  return stressPinState;
+}
+
+test(snapshot, concurrent_readers_never_see_torn_state) {
+  Button2 button;
+  stressPinState = !BUTTON_ACTIVE;
+  button.setButtonStateFunction(getStressPinState);
+  button.begin(BUTTON_PIN, BUTTON_MODE, BUTTON_ACTIVE == LOW);
+  button.setDebounceTime(0);
+  button.setDoubleClickTime(0);
+
+  std::atomic<bool> stop(false);
+  std::atomic<uint32_t> reads(0);
+  std::atomic<uint32_t> torn(0);
+  std::atomic<uint32_t> changes(0);
+
+  auto reader = [&]() {
+    uint8_t last = 0xFF;
+    while (!stop) {
+      ButtonSnapshot s = button.getSnapshot();
+      if (!isConsistent(s)) torn++;
+      if (s.clicks != last) {
+        changes++;
+        last = s.clicks;
+      }
+      reads++;
+    }
+  };
+  std::thread r1(reader);
+  std::thread r2(reader);
+
+  // writer: alternate single and double clicks, consume them via read()
+  unsigned long end = millis() + 300;
+  uint8_t n = 1;
+  while (millis() < end) {
+    for (uint8_t i = 0; i < n; i++) {
+      stressPinState = BUTTON_ACTIVE;
+      button.loop();
+      button.loop();
+      stressPinState = !BUTTON_ACTIVE;
+      button.loop();
+    }
+    // the click is reported once the (zero) double click time passed
+    for (uint8_t i = 0; i < 10 && !button.wasPressed(); i++) {
+      testDelay(1);
+      button.loop();
+    }
+    // keep the result visible for a moment before consuming it
+    delayMicroseconds(100);
+    button.read();
+    n = (n == 1) ? 2 : 1;
+  }
+  stop = true;
+  r1.join();
+  r2.join();
+
+  assertEqual(torn.load(), (uint32_t)0);
+  assertTrue(reads.load() > 1000);
+  // readers must have observed the writer making progress
+  assertTrue(changes.load() > 10);
+}
+
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+  useTestClock();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Snapshot Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
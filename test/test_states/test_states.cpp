@@ -47,7 +47,7 @@ test(states, is_pressed_during_press) {
   // Press button
   simulatedPinState = BUTTON_ACTIVE;
   button.loop();
-  delay(DEBOUNCE_MS);
+  testDelay(DEBOUNCE_MS);
   button.loop();
 
   // Should be pressed now
@@ -77,7 +77,7 @@ test(states, was_pressed_after_click) {
   assertFalse(button.wasPressed());
 
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   assertTrue(button.wasPressed());
@@ -91,7 +91,7 @@ test(states, was_pressed_for_duration) {
 
   unsigned long pressDuration = 100;
   click(button, pressDuration);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   // Should be approximately the press duration
@@ -111,7 +111,7 @@ test(states, was_pressed_for_after_read) {
 
   unsigned long pressDuration = 100;
   click(button, pressDuration);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   // Consume the click via read(), which internally calls resetPressedState()
@@ -131,7 +131,7 @@ test(states, read_returns_click_type) {
   button.resetPressedState();
 
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   assertEqual(button.read(), single_click);
@@ -144,7 +144,7 @@ test(states, read_resets_state) {
   button.resetPressedState();
 
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   assertTrue(button.wasPressed());
@@ -165,7 +165,7 @@ test(states, read_keep_state_preserves_state) {
   button.resetPressedState();
 
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   clickType t = button.read(true);
@@ -186,7 +186,7 @@ test(states, get_number_of_clicks) {
 
   // Single click
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   assertEqual(button.getNumberOfClicks(), 1);
@@ -195,7 +195,7 @@ test(states, get_number_of_clicks) {
   button.resetPressedState();
   click(button, DEBOUNCE_MS);
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   assertEqual(button.getNumberOfClicks(), 2);
@@ -209,7 +209,7 @@ test(states, get_type_after_clicks) {
   // Single click
   button.resetPressedState();
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
   assertEqual(button.getType(), single_click);
 
@@ -217,7 +217,7 @@ test(states, get_type_after_clicks) {
   button.resetPressedState();
   click(button, DEBOUNCE_MS);
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
   assertEqual(button.getType(), double_click);
 
@@ -226,14 +226,14 @@ test(states, get_type_after_clicks) {
   click(button, DEBOUNCE_MS);
   click(button, DEBOUNCE_MS);
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
   assertEqual(button.getType(), triple_click);
 
   // Long click
   button.resetPressedState();
   click(button, BTN_LONGCLICK_MS + 50);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
   assertEqual(button.getType(), long_click);
 }
@@ -247,7 +247,7 @@ test(states, reset_click_count) {
   // Double click
   click(button, DEBOUNCE_MS);
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   assertEqual(button.getNumberOfClicks(), 2);
@@ -270,7 +270,7 @@ test(states, state_transition_press_release) {
   // Press
   simulatedPinState = BUTTON_ACTIVE;
   button.loop();
-  delay(DEBOUNCE_MS);
+  testDelay(DEBOUNCE_MS);
   button.loop();
 
   // Now: pressed
@@ -279,7 +279,7 @@ test(states, state_transition_press_release) {
   // Release
   simulatedPinState = !BUTTON_ACTIVE;
   button.loop();
-  delay(5);
+  testDelay(5);
   button.loop();
 
   // Now: released again
@@ -294,7 +294,7 @@ test(states, multiple_presses_without_reset) {
 
   // First click
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
   assertTrue(button.wasPressed());
 
@@ -303,7 +303,7 @@ test(states, multiple_presses_without_reset) {
 
   // Second click without reset
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   // Still true
@@ -332,10 +332,10 @@ test(states, active_high_configuration) {
   button.loop();
 
   // Keep calling loop past debounce time
-  unsigned long startTime = millis();
-  while (millis() - startTime < (DEBOUNCE_MS + 10)) {
+  unsigned long startTime = testMillis();
+  while (testMillis() - startTime < (DEBOUNCE_MS + 10)) {
     button.loop();
-    delay(1);
+    testDelay(1);
   }
 
   // Should be pressed now
@@ -360,10 +360,10 @@ test(states, active_low_configuration) {
   button.loop();
 
   // Keep calling loop past debounce time
-  unsigned long startTime = millis();
-  while (millis() - startTime < (DEBOUNCE_MS + 10)) {
+  unsigned long startTime = testMillis();
+  while (testMillis() - startTime < (DEBOUNCE_MS + 10)) {
     button.loop();
-    delay(1);
+    testDelay(1);
   }
 
   // Should be pressed now
@@ -385,10 +385,10 @@ test(states, long_click_counter) {
   simulatedPinState = BUTTON_ACTIVE;
   button.loop();
 
-  unsigned long startTime = millis();
-  while (millis() - startTime < (BTN_LONGCLICK_MS * 3 + 100)) {
+  unsigned long startTime = testMillis();
+  while (testMillis() - startTime < (BTN_LONGCLICK_MS * 3 + 100)) {
     button.loop();
-    delay(1);
+    testDelay(1);
   }
 
   // Check counter
@@ -410,7 +410,7 @@ test(timing, click_at_debounce_boundary) {
 
   // Click for slightly more than debounce time to account for timing variations
   click(button, BTN_DEBOUNCE_MS + 5);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   // Should register as a valid click
@@ -427,11 +427,11 @@ test(timing, click_just_under_debounce) {
   // Click for just under debounce time
   simulatedPinState = BUTTON_ACTIVE;
   button.loop();
-  delay(BTN_DEBOUNCE_MS - 10);
+  testDelay(BTN_DEBOUNCE_MS - 10);
   simulatedPinState = !BUTTON_ACTIVE;
   button.loop();
 
-  delay(BTN_DOUBLECLICK_MS + 50);
+  testDelay(BTN_DOUBLECLICK_MS + 50);
   button.loop();
 
   // Should NOT register as a valid click
@@ -448,13 +448,13 @@ test(timing, double_click_at_timeout_boundary) {
   click(button, DEBOUNCE_MS);
 
   // Wait almost to the double-click timeout
-  delay(BTN_DOUBLECLICK_MS - 50);
+  testDelay(BTN_DOUBLECLICK_MS - 50);
 
   // Second click just before timeout
   click(button, DEBOUNCE_MS);
 
   // Wait for final timeout
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   // Should register as double click
@@ -470,7 +470,7 @@ test(timing, long_click_at_threshold) {
 
   // Click for EXACTLY long click time
   click(button, BTN_LONGCLICK_MS);
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   // Should register as long click
@@ -485,12 +485,12 @@ test(timing, very_fast_clicks) {
 
   // Rapid triple click with minimal gaps
   click(button, DEBOUNCE_MS);
-  delay(10); // Very short gap
+  testDelay(10); // Very short gap
   click(button, DEBOUNCE_MS);
-  delay(10); // Very short gap
+  testDelay(10); // Very short gap
   click(button, DEBOUNCE_MS);
 
-  delay(BTN_DOUBLECLICK_MS);
+  testDelay(BTN_DOUBLECLICK_MS);
   button.loop();
 
   // Should still register as triple click
@@ -513,7 +513,7 @@ test(timing, slow_clicks_become_separate) {
   click(button, DEBOUNCE_MS);
 
   // Wait beyond double-click timeout
-  delay(BTN_DOUBLECLICK_MS + 100);
+  testDelay(BTN_DOUBLECLICK_MS + 100);
   button.loop();
 
   // Should have registered first click
@@ -525,7 +525,7 @@ test(timing, slow_clicks_become_separate) {
   firstClick = false;
 
   click(button, DEBOUNCE_MS);
-  delay(BTN_DOUBLECLICK_MS + 100);
+  testDelay(BTN_DOUBLECLICK_MS + 100);
   button.loop();
 
   // Should register as separate single click, not a double click
@@ -537,6 +537,7 @@ test(timing, slow_clicks_become_separate) {
 
 void setup() {
   setup_test_runner();
+  useTestClock();
 
   // Reduced delay for faster native testing (was 1000ms)
   delay(100);
@@ -0,0 +1,393 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Instrumentation tests for Button2 library.
+  Tests the log2 histogram and the loop interval monitor.
+
+  Created by Lennart Hennigs
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+#include <Button2Stats.h>
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+
+Button2 createStatsButton() {
+  useTestClock(1000);
+  return createTestButton();
+}
+
+#define PRESSED   BUTTON_ACTIVE
+#define RELEASED  !BUTTON_ACTIVE
+
+/////////////////////////////////////////////////////////////////
+// HISTOGRAM TESTS
+/////////////////////////////////////////////////////////////////
+
+test(stats, histogram_buckets) {
+  Button2Histogram h;
+  assertEqual(h.getMin(), 0UL);
+  assertEqual(h.getPercentile(99), 0UL);
+
+  h.add(0);
+  h.add(1);
+  h.add(2);
+  h.add(3);
+  h.add(4);
+  h.add(1000);
+  assertEqual(h.getBucket(0), 1);
+  assertEqual(h.getBucket(1), 1);
+  assertEqual(h.getBucket(2), 2);
+  assertEqual(h.getBucket(3), 1);
+  assertEqual(h.getBucket(10), 1);
+  assertEqual(Button2Histogram::bucketLimit(10), 1023UL);
+  assertEqual(h.getCount(), (uint32_t)6);
+  assertEqual(h.getTotal(), 1010UL);
+  assertEqual(h.getMin(), 0UL);
+  assertEqual(h.getMax(), 1000UL);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(stats, histogram_percentiles) {
+  Button2Histogram h;
+  for (uint8_t i = 0; i < 99; i++) h.add(5);
+  h.add(300);
+  // upper limit of the bucket
+  assertEqual(h.getPercentile(50), 7UL);
+  assertEqual(h.getPercentile(99), 7UL);
+  // capped at the maximum
+  assertEqual(h.getPercentile(100), 300UL);
+
+  h.reset();
+  assertEqual(h.getCount(), (uint32_t)0);
+  assertEqual(h.getMax(), 0UL);
+}
+
+/////////////////////////////////////////////////////////////////
+// LOOP MONITOR TESTS
+/////////////////////////////////////////////////////////////////
+
+test(stats, loop_gaps) {
+  Button2 button = createStatsButton();
+  Button2LoopMonitor monitor;
+  monitor.begin(button);
+
+  for (uint8_t i = 0; i <= 100; i++) {
+    monitor.loop();
+    virtualTime += 5;
+  }
+  const Button2Histogram& gaps = monitor.getHistogram();
+  assertEqual(gaps.getCount(), (uint32_t)100);
+  assertEqual(gaps.getMin(), 5UL);
+  assertEqual(gaps.getMax(), 5UL);
+  assertEqual(monitor.getDebounceMisses(), 0);
+
+  // a stall longer than the debounce time, and one longer than the window
+  virtualTime += BTN_DEBOUNCE_MS;
+  monitor.loop();
+  virtualTime += BTN_DOUBLECLICK_MS + 100;
+  monitor.loop();
+  assertEqual(monitor.getDebounceMisses(), 2);
+  assertEqual(monitor.getDoubleClickMisses(), 1);
+  assertEqual(gaps.getMax(), (unsigned long)BTN_DOUBLECLICK_MS + 100);
+  assertEqual(gaps.getPercentile(90), 7UL);
+  // 2 of 102 gaps are long
+  unsigned long stall = BTN_DEBOUNCE_MS + 5;
+  assertEqual(gaps.getPercentile(99), Button2Histogram::bucketLimit(Button2Histogram::bucketOf(stall)));
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(stats, loop_monitor_runs_button) {
+  Button2 button = createStatsButton();
+  button.setDebounceTime(20);
+  Button2LoopMonitor monitor;
+  monitor.begin(button);
+
+  simulatedPinState = PRESSED;
+  for (uint8_t i = 0; i < 10; i++) {
+    monitor.loop();
+    virtualTime += 5;
+  }
+  assertTrue(button.isPressed());
+
+  // record() only measures
+  monitor.reset();
+  monitor.record();
+  virtualTime += 30;
+  monitor.record();
+  assertEqual(monitor.getHistogram().getCount(), (uint32_t)1);
+  assertEqual(monitor.getDebounceMisses(), 1);
+}
+
+/////////////////////////////////////////////////////////////////
+// PROFILER TESTS
+/////////////////////////////////////////////////////////////////
+
+static int overruns;
+static buttonEvent overrunEvent;
+
+test(stats, profiler_times_handlers) {
+  Button2 button = createStatsButton();
+  button.setPressedHandler([](Button2& btn) { delay(2); });
+  button.setReleasedHandler([](Button2& btn) {});
+  Button2Profiler profiler;
+  profiler.begin();
+
+  for (uint8_t i = 0; i < 3; i++) {
+    simulatedPinState = PRESSED;
+    button.loop();
+    virtualTime += DEBOUNCE_MS;
+    button.loop();
+    simulatedPinState = RELEASED;
+    button.loop();
+    virtualTime += 10;
+  }
+  profiler.end();
+
+  const Button2Histogram* pressed = profiler.getStats(button, pressed_event);
+  assertTrue(pressed != NULL);
+  assertEqual(pressed->getCount(), (uint32_t)3);
+  assertTrue(pressed->getMin() >= 2000UL);
+  assertTrue(pressed->getTotal() >= 6000UL);
+  const Button2Histogram* released = profiler.getStats(button, released_event);
+  assertEqual(released->getCount(), (uint32_t)3);
+  assertTrue(released->getMax() < pressed->getMin());
+  // no handler, nothing to time
+  assertTrue(profiler.getStats(button, tap_event) == NULL);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(stats, profiler_budget_alarm) {
+  Button2 button = createStatsButton();
+  button.setPressedHandler([](Button2& btn) { delay(3); });
+  button.setReleasedHandler([](Button2& btn) {});
+  Button2Profiler profiler;
+  profiler.begin();
+  overruns = 0;
+  profiler.setBudget(1000, [](Button2& btn, buttonEvent ev, unsigned long time) {
+    overruns++;
+    overrunEvent = ev;
+  });
+
+  simulatedPinState = PRESSED;
+  button.loop();
+  virtualTime += DEBOUNCE_MS;
+  button.loop();
+  simulatedPinState = RELEASED;
+  button.loop();
+  profiler.end();
+
+  assertEqual(overruns, 1);
+  assertEqual(overrunEvent, pressed_event);
+  assertEqual(profiler.getOverruns(button, pressed_event), 1);
+  assertEqual(profiler.getOverruns(button, released_event), 0);
+
+  // not recorded once the profiler has ended
+  simulatedPinState = PRESSED;
+  button.loop();
+  virtualTime += DEBOUNCE_MS;
+  button.loop();
+  assertEqual(overruns, 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(stats, profiler_times_event_handler_apart) {
+  Button2 button = createStatsButton();
+  button.setPressedHandler([](Button2& btn) { delay(3); });
+  button.setEventHandler([](Button2& btn, buttonEvent ev) {});
+  Button2Profiler profiler;
+  profiler.begin();
+
+  simulatedPinState = PRESSED;
+  button.loop();
+  virtualTime += DEBOUNCE_MS;
+  button.loop();
+  profiler.end();
+
+  const Button2Histogram* pressed = profiler.getStats(button, pressed_event);
+  assertEqual(pressed->getCount(), (uint32_t)1);
+  assertTrue(pressed->getMin() >= 3000UL);
+  // changed and pressed event, without the time of the pressed handler
+  const Button2Histogram* events = profiler.getEventHandlerStats(button);
+  assertEqual(events->getCount(), (uint32_t)2);
+  assertTrue(events->getMax() < 3000UL);
+  // the changed event has no specific handler
+  assertTrue(profiler.getStats(button, changed_event) == NULL);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(stats, profiler_covers_all_handlers_of_a_button) {
+  Button2 button = createStatsButton();
+  Button2Profiler profiler;
+  profiler.begin();
+  for (uint8_t ev = 0; ev < BTN_EVENT_COUNT; ev++) {
+    profiler.record(button, (buttonEvent)ev, 10, 5);
+  }
+  profiler.end();
+
+  assertEqual(profiler.getUntracked(), 0);
+  for (uint8_t ev = 0; ev < BTN_EVENT_COUNT; ev++) {
+    assertEqual(profiler.getStats(button, (buttonEvent)ev)->getTotal(), 10UL);
+  }
+  assertEqual(profiler.getEventHandlerStats(button)->getTotal(), 5UL * BTN_EVENT_COUNT);
+}
+
+/////////////////////////////////////////////////////////////////
+// LATENCY TESTS
+/////////////////////////////////////////////////////////////////
+
+static unsigned long clickEdge;
+static unsigned long clickEvent;
+
+test(stats, latency_per_event) {
+  Button2 button = createStatsButton();
+  button.setPressedHandler([](Button2& btn) {});
+  button.setClickHandler([](Button2& btn) {
+    clickEdge = btn.getEdgeTime();
+    clickEvent = btn.getEventTime();
+  });
+  Button2LatencyMonitor latency;
+  latency.begin();
+
+  unsigned long start = virtualTime;
+  run(button, PRESSED, 100);
+  run(button, RELEASED, BTN_DOUBLECLICK_MS);
+  // the press waits for the debounce time, and is called right then
+  assertEqual(latency.getWait(pressed_event).getMax(), (unsigned long)BTN_DEBOUNCE_MS);
+  assertEqual(latency.getLatency(pressed_event).getMax(), 0UL);
+  // the click for the end of the window, counted from the press
+  assertEqual(clickEdge, start + 100);
+  assertEqual(clickEvent - clickEdge, (unsigned long)BTN_DOUBLECLICK_MS + 5 - 100);
+  assertEqual(latency.getWait(click_event).getMax(), (unsigned long)BTN_DOUBLECLICK_MS + 1 - 100);
+  // the next loop() after the window, 5ms apart
+  assertEqual(latency.getLatency(click_event).getMax(), 4UL);
+  assertEqual(latency.getLatency(click_event).getCount(), (uint32_t)1);
+
+  // early resolution removes the wait
+  button.setMaxClicks(1);
+  run(button, PRESSED, 100);
+  run(button, RELEASED, 10);
+  assertEqual(latency.getWait(click_event).getMin(), 0UL);
+  assertEqual(latency.getLatency(click_event).getMin(), 0UL);
+  latency.end();
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(stats, latency_leaves_out_hold_time) {
+  Button2 button = createStatsButton();
+  button.setLongClickDetectedHandler([](Button2& btn) {});
+  Button2LatencyMonitor latency;
+  latency.begin();
+
+  run(button, PRESSED, BTN_LONGCLICK_MS + 100);
+  run(button, RELEASED, BTN_DOUBLECLICK_MS);
+  assertEqual(latency.getWait(longclick_detected_event).getMax(), (unsigned long)BTN_LONGCLICK_MS);
+  assertEqual(latency.getLatency(longclick_detected_event).getMax(), 0UL);
+
+  // a stalled loop() shows up as latency
+  simulatedPinState = PRESSED;
+  button.loop();
+  testDelay(BTN_LONGCLICK_MS + 100);
+  button.loop();
+  assertEqual(latency.getLatency(longclick_detected_event).getMax(), 100UL);
+  latency.end();
+}
+
+/////////////////////////////////////////////////////////////////
+
+static unsigned long pressEdge;
+
+// bounces every 5ms for 20ms, then stays at `level`
+void bounceTo(Button2& button, uint8_t level) {
+  for (uint8_t i = 0; i < 4; i++) {
+    run(button, level, 5);
+    run(button, !level, 5);
+  }
+  run(button, level, 100);
+}
+
+test(stats, edge_time_is_start_of_bounce_train) {
+  Button2 button = createStatsButton();
+  button.setPressedHandler([](Button2& btn) { pressEdge = btn.getEdgeTime(); });
+  Button2LatencyMonitor latency;
+  latency.begin();
+
+  // stable: the bounces don't restart the edge
+  unsigned long start = virtualTime;
+  bounceTo(button, PRESSED);
+  assertEqual(pressEdge, start);
+  run(button, RELEASED, BTN_DOUBLECLICK_MS + 10);
+
+  // integrator: the edge is not the time the filter passed the press
+  button.setDebounceMode(debounce_integrator);
+  start = virtualTime;
+  bounceTo(button, PRESSED);
+  assertEqual(pressEdge, start);
+  assertTrue(latency.getWait(pressed_event).getMax() >= (unsigned long)BTN_DEBOUNCE_MS);
+  latency.end();
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(stats, latency_with_profiler) {
+  Button2 button = createStatsButton();
+  button.setPressedHandler([](Button2& btn) {});
+  button.setDebounceMode(debounce_lockout);
+  Button2LatencyMonitor latency;
+  Button2Profiler profiler;
+  latency.begin();
+  profiler.begin();
+
+  run(button, PRESSED, 20);
+  profiler.end();
+  run(button, RELEASED, 2 * BTN_DEBOUNCE_MS);
+  run(button, PRESSED, 20);
+  latency.end();
+
+  // lockout: no press latency
+  assertEqual(latency.getLatency(pressed_event).getCount(), (uint32_t)2);
+  assertEqual(latency.getLatency(pressed_event).getMax(), 0UL);
+  assertEqual(profiler.getStats(button, pressed_event)->getCount(), (uint32_t)1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Instrumentation Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,177 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Throttling tests for Button2 library.
+  Tests coalescing of retriggered long clicks and the per-button
+  and global event rate limits.
+
+  Created by Lennart Hennigs
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+
+static int detectedCalls;
+static int detectedRepeats;
+static int pressedCalls;
+static int clickCalls;
+
+Button2 createThrottleButton() {
+  useTestClock(1000);
+  Button2 button = createTestButton();
+  detectedCalls = detectedRepeats = pressedCalls = clickCalls = 0;
+  button.setLongClickDetectedHandler([](Button2& btn) {
+    detectedCalls++;
+    detectedRepeats += btn.getLongClickRepeats();
+  });
+  button.setPressedHandler([](Button2& btn) { pressedCalls++; });
+  return button;
+}
+
+#define PRESSED   BUTTON_ACTIVE
+#define RELEASED  !BUTTON_ACTIVE
+
+/////////////////////////////////////////////////////////////////
+// THROTTLE TESTS
+/////////////////////////////////////////////////////////////////
+
+test(throttle, no_coalescing_by_default) {
+  Button2 button = createThrottleButton();
+  button.setLongClickDetectedRetriggerable(true, 20);
+  assertEqual(button.getLongClickCoalesceTime(), 0U);
+
+  run(button, PRESSED, BTN_LONGCLICK_MS + 200);
+  assertEqual(detectedCalls, (int)button.getLongClickCount());
+  assertEqual(detectedRepeats, detectedCalls);
+  assertEqual(button.getLongClickRepeats(), 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(throttle, retriggers_coalesced) {
+  ButtonExtension ext;
+  Button2 button = createThrottleButton();
+  button.setExtension(&ext);
+  button.setLongClickDetectedRetriggerable(true, 20);
+  button.setLongClickCoalesceTime(100);
+
+  run(button, PRESSED, BTN_LONGCLICK_MS + 800);
+  uint16_t count = button.getLongClickCount();
+  // one detection every 20ms, exactly counted
+  assertEqual(count, 40);
+  // the first one right away, then one call per 100ms
+  assertEqual(detectedCalls, 8);
+  assertEqual(detectedRepeats, 36);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(throttle, coalesced_passed_on_at_release) {
+  ButtonExtension ext;
+  Button2 button = createThrottleButton();
+  button.setExtension(&ext);
+  button.setLongClickDetectedRetriggerable(true, 20);
+  button.setLongClickCoalesceTime(100);
+
+  run(button, PRESSED, BTN_LONGCLICK_MS + 150);
+  uint16_t count = button.getLongClickCount();
+  assertTrue(detectedRepeats < (int)count);
+  run(button, RELEASED, 10);
+  // nothing is lost
+  assertEqual(detectedRepeats, (int)count);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(throttle, rate_limit_per_button) {
+  ButtonExtension ext;
+  Button2 button = createThrottleButton();
+  button.setExtension(&ext);
+  button.setDebounceTime(5);
+  button.setMaxClicks(1);
+  button.setClickHandler([](Button2& btn) { clickCalls++; });
+  button.setRateLimit(2, 100);
+
+  // mash the button: 10 clicks within 400ms
+  for (uint8_t i = 0; i < 10; i++) {
+    run(button, PRESSED, 20);
+    run(button, RELEASED, 20);
+  }
+  // a burst of two, then one per 100ms
+  assertEqual(clickCalls, 5);
+  assertEqual(button.getThrottledEvents(), 5);
+  // the state edges are not limited
+  assertEqual(pressedCalls, 10);
+
+  // refilled after a pause
+  run(button, RELEASED, 200);
+  run(button, PRESSED, 20);
+  run(button, RELEASED, 20);
+  assertEqual(clickCalls, 6);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(throttle, global_rate_limit) {
+  Button2 a = createThrottleButton();
+  Button2 b = createTestButton();
+  a.setMaxClicks(1);
+  b.setMaxClicks(1);
+  a.setClickHandler([](Button2& btn) { clickCalls++; });
+  b.setClickHandler([](Button2& btn) { clickCalls++; });
+  b.setPressedHandler([](Button2& btn) { pressedCalls++; });
+  Button2::setGlobalRateLimit(1, 1000);
+
+  for (uint8_t i = 0; i < 2; i++) {
+    simulatedPinState = (simulatedPinState == PRESSED) ? RELEASED : PRESSED;
+    for (uint8_t j = 0; j < 20; j++) {
+      a.loop();
+      b.loop();
+      virtualTime += 5;
+    }
+  }
+  uint16_t throttled = Button2::getGlobalThrottledEvents();
+  Button2::setGlobalRateLimit(0, 0);
+  assertEqual(clickCalls, 1);
+  assertEqual(throttled, (uint16_t)1);
+  // counted per button only with a limit of its own
+  assertEqual(a.getThrottledEvents() + b.getThrottledEvents(), 0);
+  assertEqual(pressedCalls, 2);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Throttling Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
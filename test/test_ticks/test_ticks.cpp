@@ -0,0 +1,172 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Tick mode tests for Button2 library.
+  Tests the fixed-rate time base: timing comes from the number of
+  loop() calls, not from millis().
+
+  Created by Lennart Hennigs
+  Requires -DBUTTON2_TICK_MS=5, see the test_ticks environment
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+
+#ifdef BUTTON2_TICK_MS
+
+static int clicks;
+static int doubleClicks;
+static int longDetected;
+
+Button2 createTickButton() {
+  Button2 button = createTestButton();
+  clicks = doubleClicks = longDetected = 0;
+  button.setClickHandler([](Button2& btn) { clicks++; });
+  button.setDoubleClickHandler([](Button2& btn) { doubleClicks++; });
+  button.setLongClickDetectedHandler([](Button2& btn) { longDetected++; });
+  return button;
+}
+
+// call loop() as a timer would for `ms`, without any delay
+void tickFor(Button2& button, uint8_t level, unsigned long ms) {
+  simulatedPinState = level;
+  for (unsigned long t = 0; t < ms; t += BUTTON2_TICK_MS) {
+    button.loop();
+  }
+}
+
+#define PRESSED   BUTTON_ACTIVE
+#define RELEASED  !BUTTON_ACTIVE
+
+/////////////////////////////////////////////////////////////////
+// TICK TESTS
+/////////////////////////////////////////////////////////////////
+
+test(ticks, timestamps_are_16_bit) {
+  assertEqual(sizeof(button2_time_t), (size_t)2);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(ticks, click_without_real_time) {
+  Button2 button = createTickButton();
+  unsigned long start = millis();
+
+  tickFor(button, PRESSED, BTN_DEBOUNCE_MS + BUTTON2_TICK_MS);
+  // the double click window is counted from the press
+  tickFor(button, RELEASED, BTN_DOUBLECLICK_MS - BTN_DEBOUNCE_MS - BUTTON2_TICK_MS);
+  assertEqual(clicks, 0);
+  tickFor(button, RELEASED, 2 * BUTTON2_TICK_MS);
+  assertEqual(clicks, 1);
+  assertEqual(button.wasPressedFor(), BTN_DEBOUNCE_MS + BUTTON2_TICK_MS);
+  // no time has passed on the wall clock
+  assertTrue(millis() - start < BTN_DEBOUNCE_MS);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(ticks, debounce_in_ticks) {
+  Button2 button = createTickButton();
+  // one tick short of the debounce time
+  tickFor(button, PRESSED, BTN_DEBOUNCE_MS);
+  tickFor(button, RELEASED, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(clicks, 0);
+  assertFalse(button.wasPressed());
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(ticks, double_and_long_click) {
+  Button2 button = createTickButton();
+  tickFor(button, PRESSED, 60);
+  tickFor(button, RELEASED, 60);
+  tickFor(button, PRESSED, 60);
+  tickFor(button, RELEASED, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(doubleClicks, 1);
+
+  tickFor(button, PRESSED, BTN_LONGCLICK_MS);
+  assertEqual(longDetected, 0);
+  tickFor(button, PRESSED, 2 * BUTTON2_TICK_MS);
+  assertEqual(longDetected, 1);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(ticks, deadline_in_ticks) {
+  Button2 button = createTickButton();
+  tickFor(button, PRESSED, 60);
+  tickFor(button, RELEASED, BUTTON2_TICK_MS);
+  unsigned long next = button.timeToNextDeadline();
+  // the window is counted from the press, 60ms ago
+  assertEqual(next, BTN_DOUBLECLICK_MS + 1 - 60UL);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(ticks, clock_wraps) {
+  Button2 button = createTickButton();
+  // run the 16 bit clock close to its end
+  tickFor(button, RELEASED, 65536UL - 100);
+  tickFor(button, PRESSED, 60);
+  tickFor(button, RELEASED, 60);
+  tickFor(button, PRESSED, 60);
+  tickFor(button, RELEASED, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(doubleClicks, 1);
+  assertEqual(clicks, 0);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(ticks, long_hold_ends_retriggers_at_clock_range) {
+  Button2 button = createTickButton();
+  button.setLongClickDetectedRetriggerable(true, 1000);
+  assertEqual(BTN_MAX_HOLD_MS, 65535UL);
+
+  // detections at 200ms, 1.2s, ... 65.2s, the last one that fits
+  tickFor(button, PRESSED, 60000UL);
+  assertEqual(longDetected, 60);
+  tickFor(button, PRESSED, 40000UL);
+  assertEqual(longDetected, 66);
+  assertTrue(button.timeToNextDeadline() == BTN_NO_DEADLINE);
+  tickFor(button, RELEASED, BTN_DOUBLECLICK_MS + 10);
+  assertEqual(button.getType(), long_click);
+}
+
+#endif
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Tick Mode Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
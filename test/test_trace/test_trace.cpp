@@ -0,0 +1,177 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Trace recorder tests for Button2 library.
+  Tests Button2TraceRecorder: raw input changes of several buttons
+  in the varint delta format, the ring buffer and the text dump.
+
+  Created by Lennart Hennigs
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+#include <Button2Trace.h>
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+
+Button2 createTraceButton() {
+  useTestClock(1000);
+  return createTestButton();
+}
+
+#define PRESSED   BUTTON_ACTIVE
+#define RELEASED  !BUTTON_ACTIVE
+
+// collects printed text
+class TextPrint : public Print {
+ public:
+  String text;
+  size_t write(uint8_t c) override {
+    text += (char)c;
+    return 1;
+  }
+};
+
+/////////////////////////////////////////////////////////////////
+// TRACE TESTS
+/////////////////////////////////////////////////////////////////
+
+test(trace, records_raw_changes) {
+  Button2 button = createTraceButton();
+  Button2TraceRecorder recorder;
+  recorder.begin();
+
+  // a bouncing press, a clean release
+  run(button, PRESSED, 5);
+  run(button, RELEASED, 5);
+  run(button, PRESSED, 100);
+  run(button, RELEASED, 100);
+  recorder.end();
+  // not recorded any more
+  run(button, PRESSED, 100);
+  assertEqual(recorder.getRecords(), 4);
+  // a byte for the ID and level, one for the delta
+  assertEqual(recorder.getSize(), 8);
+
+  uint8_t bytes[BUTTON2_TRACE_SIZE];
+  uint16_t len = recorder.copyTo(bytes, sizeof(bytes));
+  Button2TraceReader reader(bytes, len, recorder.getBaseTime());
+  Button2TraceRecord rec;
+  const unsigned long times[] = {1000, 1005, 1010, 1110};
+  for (uint8_t i = 0; i < 4; i++) {
+    assertTrue(reader.next(rec));
+    assertEqual(rec.time, times[i]);
+    assertEqual(rec.level, (uint8_t)((i % 2) ? RELEASED : PRESSED));
+    assertEqual(rec.id, (uint16_t)button.getID());
+  }
+  assertFalse(reader.next(rec));
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(trace, records_of_several_buttons) {
+  Button2 a = createTraceButton();
+  Button2 b = createTestButton();
+  b.setID(300);
+  Button2TraceRecorder recorder;
+  recorder.begin();
+
+  simulatedPinState = PRESSED;
+  a.loop();
+  virtualTime += 1000;
+  b.loop();
+  recorder.end();
+
+  uint8_t bytes[16];
+  Button2TraceReader reader(bytes, recorder.copyTo(bytes, sizeof(bytes)), recorder.getBaseTime());
+  Button2TraceRecord rec;
+  assertTrue(reader.next(rec));
+  assertEqual(rec.id, (uint16_t)a.getID());
+  assertTrue(reader.next(rec));
+  assertEqual(rec.id, 300);
+  assertEqual(rec.time, 2000UL);
+  // two bytes each for the larger ID and delta
+  assertEqual(recorder.getSize(), 2 + 4);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(trace, full_buffer_drops_oldest) {
+  Button2 button = createTraceButton();
+  Button2TraceRecorder recorder;
+  recorder.begin();
+
+  for (uint16_t i = 0; i < BUTTON2_TRACE_SIZE; i++) {
+    run(button, (i % 2) ? RELEASED : PRESSED, 5);
+  }
+  recorder.end();
+  assertEqual(recorder.getRecords(), BUTTON2_TRACE_SIZE / 2);
+  assertEqual(recorder.getDroppedRecords(), BUTTON2_TRACE_SIZE / 2);
+
+  // the remaining records keep their absolute times
+  uint8_t bytes[BUTTON2_TRACE_SIZE];
+  Button2TraceReader reader(bytes, recorder.copyTo(bytes, sizeof(bytes)), recorder.getBaseTime());
+  Button2TraceRecord rec;
+  unsigned long expected = 1000 + (BUTTON2_TRACE_SIZE / 2) * 5;
+  while (reader.next(rec)) {
+    assertEqual(rec.time, expected);
+    expected += 5;
+  }
+  assertEqual(expected, virtualTime);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(trace, dump_as_text) {
+  Button2 button = createTraceButton();
+  button.setID(0);
+  Button2TraceRecorder recorder;
+  recorder.begin();
+  run(button, PRESSED, 200);
+  run(button, RELEASED, 5);
+  recorder.end();
+
+  TextPrint out;
+  recorder.dump(out);
+  // ID 0 pressed (0x00 | level), delta 0; released, delta 200 = 0xc8 0x01
+  String expected = "B2T1,1000,0,";
+  expected += (PRESSED ? "0100" : "0000");
+  expected += (RELEASED ? "01c801" : "00c801");
+  expected += "\n";
+  assertEqual(out.text, expected);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Trace Recorder Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////
@@ -0,0 +1,204 @@
+/////////////////////////////////////////////////////////////////
+/*
+  Wait function tests for Button2 library.
+  Tests the timeout variants of wait(), waitFor*(), waitAny() and
+  the sleep hook. The hook also plays a scripted button sequence.
+
+  Created by Lennart Hennigs
+*/
+/////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <AUnitVerbose.h>
+#include "../shared/test_helpers.h"
+
+using namespace aunit;
+
+/////////////////////////////////////////////////////////////////
+
+#define SERIAL_SPEED 115200
+
+/////////////////////////////////////////////////////////////////
+
+void setup_test_runner() {
+  TestRunner::setVerbosity(Verbosity::kDefault);
+  TestRunner::setTimeout(90);
+  TestRunner::list();
+}
+
+/////////////////////////////////////////////////////////////////
+
+// Scripted presses: pressed while (elapsed - start) % period < hold,
+// for `presses` periods. Applied to `target` each time the wait
+// functions go to sleep.
+static unsigned long scriptStart;
+static unsigned long scriptPeriod;
+static unsigned long scriptHold;
+static uint8_t scriptPresses;
+static uint8_t* scriptTarget;
+static uint16_t sleepCalls;
+
+static uint8_t otherPinState = HIGH;
+
+uint8_t getOtherPinState() {
+  return otherPinState;
+}
+
+void startScript(uint8_t* target, uint8_t presses, unsigned long hold, unsigned long period = 120) {
+  scriptTarget = target;
+  scriptPresses = presses;
+  scriptHold = hold;
+  scriptPeriod = period;
+  scriptStart = testMillis();
+  sleepCalls = 0;
+}
+
+void scriptedSleep(unsigned long ms) {
+  sleepCalls++;
+  testDelay(ms);
+  unsigned long t = testMillis() - scriptStart;
+  bool active = (t / scriptPeriod < scriptPresses) && (t % scriptPeriod < scriptHold);
+  if (scriptTarget != NULL) *scriptTarget = active ? BUTTON_ACTIVE : !BUTTON_ACTIVE;
+}
+
+/////////////////////////////////////////////////////////////////
+// WAIT TESTS
+/////////////////////////////////////////////////////////////////
+
+test(wait, times_out_without_click) {
+  Button2 button = createTestButton();
+  Button2::setSleepFunction(scriptedSleep);
+  startScript(NULL, 0, 0);
+
+  unsigned long start = testMillis();
+  assertEqual(button.wait(false, 50), clickType::empty);
+  unsigned long elapsed = testMillis() - start;
+  assertTrue(elapsed >= 50);
+  assertTrue(elapsed < 70);
+  // sleeps instead of spinning
+  assertTrue(sleepCalls <= 50 / BTN_WAIT_POLL_MS + 2);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(wait, returns_click_within_timeout) {
+  Button2 button = createTestButton();
+  Button2::setSleepFunction(scriptedSleep);
+  startScript(&simulatedPinState, 1, 80);
+
+  assertEqual(button.wait(false, 1000), single_click);
+  assertFalse(button.wasPressed());
+  // click reported at the end of the double click window
+  assertTrue(testMillis() - scriptStart < BTN_DOUBLECLICK_MS + 50);
+  assertTrue(sleepCalls < (BTN_DOUBLECLICK_MS + 50) / BTN_WAIT_POLL_MS);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(wait, keeps_state_if_requested) {
+  Button2 button = createTestButton();
+  Button2::setSleepFunction(scriptedSleep);
+  startScript(&simulatedPinState, 2, 80);
+
+  assertEqual(button.wait(true, 1000), double_click);
+  assertTrue(button.wasPressed());
+  assertEqual(button.read(), double_click);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(wait, wait_for_type) {
+  Button2 button = createTestButton();
+  Button2::setSleepFunction(scriptedSleep);
+
+  // only a single click happens
+  startScript(&simulatedPinState, 1, 80);
+  assertFalse(button.waitForDouble(false, 600));
+
+  startScript(&simulatedPinState, 2, 80);
+  assertTrue(button.waitForDouble(false, 1000));
+
+  startScript(&simulatedPinState, 1, BTN_LONGCLICK_MS + 50, 1000);
+  assertTrue(button.waitForLong(false, 1000));
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(wait, wait_any_returns_clicked_button) {
+  Button2 first = createTestButton();
+  Button2 second;
+  otherPinState = !BUTTON_ACTIVE;
+  second.setButtonStateFunction(getOtherPinState);
+  second.begin(BUTTON_PIN, BUTTON_MODE, BUTTON_ACTIVE == LOW);
+  Button2* buttons[] = { &first, &second };
+
+  Button2::setSleepFunction(scriptedSleep);
+  startScript(NULL, 0, 0);
+  assertTrue(Button2::waitAny(buttons, 2, 30) == NULL);
+
+  startScript(&otherPinState, 1, 80);
+  assertTrue(Button2::waitAny(buttons, 2, 1000) == &second);
+  assertEqual(second.read(), single_click);
+  assertFalse(first.wasPressed());
+}
+
+/////////////////////////////////////////////////////////////////
+
+void virtualSleep(unsigned long ms) {
+  virtualTime += ms;
+}
+
+test(wait, timeout_on_button_clock) {
+  auto clock = Button2::getTimeFunction();
+  Button2::setTimeFunction(getVirtualTime);
+  Button2::setSleepFunction(virtualSleep);
+  Button2 button = createTestButton();
+  Button2* buttons[] = { &button };
+
+  // a minute on the button's clock, no time in real life
+  unsigned long start = millis();
+  unsigned long virtualStart = virtualTime;
+  assertFalse(button.waitForClick(false, 60000UL));
+  assertEqual(virtualTime - virtualStart, 60000UL);
+  assertTrue(Button2::waitAny(buttons, 1, 30000UL) == NULL);
+  assertEqual(virtualTime - virtualStart, 90000UL);
+  assertTrue(millis() - start < 1000);
+
+  Button2::setTimeFunction(clock);
+}
+
+/////////////////////////////////////////////////////////////////
+
+test(wait, default_sleep_is_delay) {
+  // delay() only passes time on the real clock
+  auto clock = Button2::getTimeFunction();
+  Button2::setTimeFunction(BUTTON2_NULL);
+  Button2 button = createTestButton();
+  Button2::setSleepFunction(BUTTON2_NULL);
+
+  unsigned long start = millis();
+  assertFalse(button.waitForClick(false, 20));
+  assertTrue(millis() - start >= 20);
+  Button2::setTimeFunction(clock);
+}
+
+/////////////////////////////////////////////////////////////////
+
+void setup() {
+  setup_test_runner();
+  useTestClock();
+
+  delay(100);  // Reduced for faster native testing
+  Serial.begin(SERIAL_SPEED);
+  while(!Serial) {}
+  Serial.println(F("\n\nButton2 Wait Tests"));
+  Serial.println(F("Using EpoxyDuino + PlatformIO"));
+}
+
+/////////////////////////////////////////////////////////////////
+
+void loop() {
+  aunit::TestRunner::run();
+}
+
+/////////////////////////////////////////////////////////////////